@@ -0,0 +1,418 @@
+/**
+ * Copyright (c) 2020 Emanuele Bellocchia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Contention and scaling benchmark.
+ * It runs a configurable mix of GetFactory, CreateObject and OverwriteFactory operations on a shared
+ * FactoryInjector from 1 to N threads, for a fixed duration, and reports throughput and latency
+ * percentiles for each operation.
+ *
+ * FactoryInjector is not internally synchronized: as an application would do, the benchmark protects
+ * it with a reader/writer lock when the mix contains OverwriteFactory operations, and accesses it
+ * without locking otherwise.
+ *
+ * Usage:
+ *   bench_contention [--threads N] [--duration-ms D] [--mix GET:CREATE:OVERWRITE] [--mode shared|per-thread|all]
+ */
+
+/*
+ * Includes
+ */
+
+// Standard
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+// Project
+#include "factory_injector.hpp"
+
+/*
+ * Using directives
+ */
+using namespace factory_injector;
+
+/*
+ * Types
+ */
+
+// Clock type
+using tClock = std::chrono::steady_clock;
+
+// Operations
+enum Operation
+{
+    kOpGet,
+    kOpCreate,
+    kOpOverwrite,
+    kOpCount,
+};
+
+// Factory modes
+enum class Mode
+{
+    Shared,
+    PerThread,
+};
+
+// Benchmark configuration
+struct Config
+{
+    unsigned int mMaxThreads    = std::max(1u, std::thread::hardware_concurrency());
+    unsigned int mDurationMs    = 1000;
+    unsigned int mMix[kOpCount] = { 80, 19, 1 };
+    bool         mRunShared     = true;
+    bool         mRunPerThread  = true;
+};
+
+// Results of a single thread
+struct ThreadResult
+{
+    std::uint64_t              mOpCount[kOpCount] = {};
+    std::vector<std::uint32_t> mLatencies[kOpCount];
+};
+
+/*
+ * Classes
+ */
+
+// Benchmark object interface
+class IBenchObj
+{
+    public:
+      virtual ~IBenchObj(void)           = default;
+      virtual std::uint64_t Get(void) const = 0;
+};
+
+// Benchmark object
+class BenchObj : public IBenchObj
+{
+    public:
+      BenchObj(const std::uint64_t cValue) :
+        mValue(cValue)
+      {}
+
+      std::uint64_t Get(void) const override
+      {
+          return mValue;
+      }
+
+    private:
+      std::uint64_t mValue;
+};
+
+// Benchmark factory interface
+class IBenchObjFactory : public FactoryTraits<IBenchObjFactory, IBenchObj>
+{
+    public:
+      virtual ~IBenchObjFactory(void)                     = default;
+      virtual tObjectPtr Create(const std::uint64_t cSeed) const = 0;
+};
+
+// Stateful benchmark factory, it counts the created objects
+template<std::uint64_t VMultiplier>
+class BenchObjFactory : public IBenchObjFactory
+{
+    public:
+      tObjectPtr Create(const std::uint64_t cSeed) const override
+      {
+          return std::make_unique<BenchObj>(cSeed * VMultiplier + mCreated.fetch_add(1, std::memory_order_relaxed));
+      }
+
+    private:
+      mutable std::atomic<std::uint64_t> mCreated{0};
+};
+
+/*
+ * Constants
+ */
+
+// Maximum number of latency samples per thread and operation
+static constexpr std::size_t kMaxSamples = 1u << 22;
+// Operation names
+static const char *kOpNames[kOpCount] = { "GetFactory", "CreateObject", "OverwriteFactory" };
+
+/*
+ * Functions
+ */
+
+// Register the benchmark factory
+static void RegisterFactory(FactoryInjector& rFactoryInjector,
+                            const Mode cMode,
+                            const bool cAlternative)
+{
+    if (cMode == Mode::Shared)
+    {
+        if (cAlternative) { rFactoryInjector.OverwriteFactory<BenchObjFactory<3>>(); }
+        else              { rFactoryInjector.OverwriteFactory<BenchObjFactory<2>>(); }
+    }
+    else
+    {
+        if (cAlternative) { rFactoryInjector.OverwriteFactoryPerThread<BenchObjFactory<3>>(); }
+        else              { rFactoryInjector.OverwriteFactoryPerThread<BenchObjFactory<2>>(); }
+    }
+}
+
+// Get the latency percentile, samples shall be sorted
+static std::uint32_t Percentile(const std::vector<std::uint32_t>& rcSamples,
+                                const double cPercentile)
+{
+    if (rcSamples.empty())
+    {
+        return 0;
+    }
+
+    auto idx = static_cast<std::size_t>(cPercentile * static_cast<double>(rcSamples.size() - 1));
+    return rcSamples[idx];
+}
+
+// Run the benchmark for a given mode and number of threads
+static void RunBenchmark(const Config& rcConfig,
+                         const Mode cMode,
+                         const unsigned int cThreadCount)
+{
+    FactoryInjector   fi;
+    std::shared_mutex fi_mutex;
+    std::atomic<bool> start(false);
+    std::atomic<bool> stop(false);
+    std::atomic<std::uint64_t> overwrite_count(0);
+
+    const bool cLocking = (rcConfig.mMix[kOpOverwrite] != 0);
+    const unsigned int cMixTotal = rcConfig.mMix[kOpGet] + rcConfig.mMix[kOpCreate] + rcConfig.mMix[kOpOverwrite];
+
+    RegisterFactory(fi, cMode, false);
+
+    std::vector<ThreadResult> results(cThreadCount);
+    std::vector<std::thread> threads;
+    for (unsigned int thread_idx = 0; thread_idx < cThreadCount; thread_idx++)
+    {
+        threads.emplace_back([&, thread_idx]()
+        {
+            ThreadResult& result = results[thread_idx];
+            std::minstd_rand rng(thread_idx + 1);
+            std::uint64_t sink = 0;
+
+            for (auto& latencies : result.mLatencies)
+            {
+                latencies.reserve(1u << 16);
+            }
+
+            while (!start.load(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                // Choose operation according to mix
+                unsigned int choice = static_cast<unsigned int>(rng() % cMixTotal);
+                Operation op = (choice < rcConfig.mMix[kOpGet])                             ? kOpGet :
+                               (choice < rcConfig.mMix[kOpGet] + rcConfig.mMix[kOpCreate])   ? kOpCreate :
+                                                                                             kOpOverwrite;
+
+                auto start_time = tClock::now();
+                switch (op)
+                {
+                    case kOpGet:
+                        if (cLocking)
+                        {
+                            std::shared_lock<std::shared_mutex> lock(fi_mutex);
+                            sink += reinterpret_cast<std::uintptr_t>(&fi.GetFactory<IBenchObjFactory>());
+                        }
+                        else
+                        {
+                            sink += reinterpret_cast<std::uintptr_t>(&fi.GetFactory<IBenchObjFactory>());
+                        }
+                        break;
+                    case kOpCreate:
+                        if (cLocking)
+                        {
+                            std::shared_lock<std::shared_mutex> lock(fi_mutex);
+                            sink += fi.CreateObject<IBenchObjFactory>(sink)->Get();
+                        }
+                        else
+                        {
+                            sink += fi.CreateObject<IBenchObjFactory>(sink)->Get();
+                        }
+                        break;
+                    default:
+                        {
+                            std::unique_lock<std::shared_mutex> lock(fi_mutex);
+                            RegisterFactory(fi, cMode, (overwrite_count.fetch_add(1, std::memory_order_relaxed) & 1) != 0);
+                        }
+                        break;
+                }
+                auto stop_time = tClock::now();
+
+                result.mOpCount[op]++;
+                if (result.mLatencies[op].size() < kMaxSamples)
+                {
+                    auto elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(stop_time - start_time).count();
+                    result.mLatencies[op].push_back(static_cast<std::uint32_t>(std::min<long long>(elapsed_ns, UINT32_MAX)));
+                }
+            }
+
+            // Avoid the compiler to optimize away the operations
+            if (sink == 1)
+            {
+                std::printf(" ");
+            }
+        });
+    }
+
+    // Run for the configured duration
+    auto start_time = tClock::now();
+    start.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(std::chrono::milliseconds(rcConfig.mDurationMs));
+    stop.store(true, std::memory_order_relaxed);
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    double elapsed_s = std::chrono::duration<double>(tClock::now() - start_time).count();
+
+    // Merge and print results
+    for (int op = 0; op < kOpCount; op++)
+    {
+        std::uint64_t op_count = 0;
+        std::vector<std::uint32_t> latencies;
+        for (auto& result : results)
+        {
+            op_count += result.mOpCount[op];
+            latencies.insert(latencies.end(), result.mLatencies[op].begin(), result.mLatencies[op].end());
+        }
+        if (op_count == 0)
+        {
+            continue;
+        }
+        std::sort(latencies.begin(), latencies.end());
+
+        std::printf("%-10s %7u  %-16s %14.0f %10u %10u %10u\n",
+                    (cMode == Mode::Shared) ? "shared" : "per-thread",
+                    cThreadCount,
+                    kOpNames[op],
+                    static_cast<double>(op_count) / elapsed_s,
+                    Percentile(latencies, 0.50),
+                    Percentile(latencies, 0.99),
+                    Percentile(latencies, 0.999));
+    }
+}
+
+// Print usage
+static void PrintUsage(const char *pProgName)
+{
+    std::printf("Usage: %s [--threads N] [--duration-ms D] [--mix GET:CREATE:OVERWRITE] [--mode shared|per-thread|all]\n", pProgName);
+}
+
+// Parse command line, return false in case of errors
+static bool ParseArgs(int argc,
+                      char *argv[],
+                      Config& rConfig)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char *p_arg = argv[i];
+        const char *p_val = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+        if (p_val == nullptr)
+        {
+            return false;
+        }
+
+        if (std::strcmp(p_arg, "--threads") == 0)
+        {
+            rConfig.mMaxThreads = static_cast<unsigned int>(std::strtoul(p_val, nullptr, 10));
+        }
+        else if (std::strcmp(p_arg, "--duration-ms") == 0)
+        {
+            rConfig.mDurationMs = static_cast<unsigned int>(std::strtoul(p_val, nullptr, 10));
+        }
+        else if (std::strcmp(p_arg, "--mix") == 0)
+        {
+            if (std::sscanf(p_val, "%u:%u:%u", &rConfig.mMix[kOpGet], &rConfig.mMix[kOpCreate], &rConfig.mMix[kOpOverwrite]) != 3)
+            {
+                return false;
+            }
+        }
+        else if (std::strcmp(p_arg, "--mode") == 0)
+        {
+            std::string mode(p_val);
+            rConfig.mRunShared    = (mode == "shared")     || (mode == "all");
+            rConfig.mRunPerThread = (mode == "per-thread") || (mode == "all");
+            if (!rConfig.mRunShared && !rConfig.mRunPerThread)
+            {
+                return false;
+            }
+        }
+        else
+        {
+            return false;
+        }
+        i++;
+    }
+
+    return (rConfig.mMaxThreads != 0) &&
+           (rConfig.mMix[kOpGet] + rConfig.mMix[kOpCreate] + rConfig.mMix[kOpOverwrite] != 0);
+}
+
+// Main function
+int main(int argc, char *argv[])
+{
+    Config config;
+    if (!ParseArgs(argc, argv, config))
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    std::printf("%-10s %7s  %-16s %14s %10s %10s %10s\n", "mode", "threads", "operation", "ops/s", "p50(ns)", "p99(ns)", "p999(ns)");
+
+    // Thread counts: powers of two up to the maximum, plus the maximum itself
+    std::vector<unsigned int> thread_counts;
+    for (unsigned int count = 1; count < config.mMaxThreads; count *= 2)
+    {
+        thread_counts.push_back(count);
+    }
+    thread_counts.push_back(config.mMaxThreads);
+
+    for (auto thread_count : thread_counts)
+    {
+        if (config.mRunShared)
+        {
+            RunBenchmark(config, Mode::Shared, thread_count);
+        }
+        if (config.mRunPerThread)
+        {
+            RunBenchmark(config, Mode::PerThread, thread_count);
+        }
+    }
+
+    return 0;
+}
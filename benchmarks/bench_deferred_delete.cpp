@@ -0,0 +1,224 @@
+/**
+ * Copyright (c) 2020 Emanuele Bellocchia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Deferred delete benchmark.
+ * It simulates a request thread that creates an object graph, uses it and releases it for each request,
+ * and it compares the request latency with the default delete policy and with the deferred one.
+ *
+ * Usage:
+ *   bench_deferred_delete [--requests N] [--nodes M]
+ */
+
+/*
+ * Includes
+ */
+
+// Standard
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+// Project
+#include "deferred_delete.hpp"
+#include "factory_injector.hpp"
+
+/*
+ * Using directives
+ */
+using namespace factory_injector;
+
+/*
+ * Types
+ */
+
+// Clock type
+using tClock = std::chrono::steady_clock;
+
+/*
+ * Classes
+ */
+
+// Graph node
+struct Node
+{
+    std::unique_ptr<Node> mNextPtr;
+    std::vector<char>     mPayload = std::vector<char>(64, 1);
+};
+
+// Graph interface
+class IGraph
+{
+    public:
+      virtual ~IGraph(void)         = default;
+      virtual long Visit(void) const = 0;
+};
+
+// Graph, a list of nodes that is deep to destroy
+class Graph : public IGraph
+{
+    public:
+      Graph(const std::size_t cNodeCount)
+      {
+          for (std::size_t i = 0; i < cNodeCount; i++)
+          {
+              auto node_ptr = std::make_unique<Node>();
+              node_ptr->mNextPtr = std::move(mHeadPtr);
+              mHeadPtr = std::move(node_ptr);
+          }
+      }
+
+      ~Graph(void) override
+      {
+          // Destroy iteratively, for avoiding deep recursion
+          while (mHeadPtr)
+          {
+              mHeadPtr = std::move(mHeadPtr->mNextPtr);
+          }
+      }
+
+      long Visit(void) const override
+      {
+          long sum = 0;
+          for (const Node* p_node = mHeadPtr.get(); p_node != nullptr; p_node = p_node->mNextPtr.get())
+          {
+              sum += p_node->mPayload[0];
+          }
+          return sum;
+      }
+
+    private:
+      std::unique_ptr<Node> mHeadPtr;
+};
+
+// Graph factory interface, with the specified delete policy
+template<class TDeletePolicy>
+class IGraphFactory : public FactoryTraits<IGraphFactory<TDeletePolicy>, IGraph, TDeletePolicy>
+{
+    public:
+      using tObjectPtr = typename FactoryTraits<IGraphFactory<TDeletePolicy>, IGraph, TDeletePolicy>::tObjectPtr;
+
+      virtual ~IGraphFactory(void)                                   = default;
+      virtual tObjectPtr Create(const std::size_t cNodeCount) const = 0;
+};
+
+// Graph factory
+template<class TDeletePolicy>
+class GraphFactory : public IGraphFactory<TDeletePolicy>
+{
+    public:
+      using tObjectPtr = typename IGraphFactory<TDeletePolicy>::tObjectPtr;
+
+      tObjectPtr Create(const std::size_t cNodeCount) const override
+      {
+          return std::make_unique<Graph>(cNodeCount);
+      }
+};
+
+/*
+ * Functions
+ */
+
+// Get the latency percentile, samples shall be sorted
+static std::uint64_t Percentile(const std::vector<std::uint64_t>& rcSamples,
+                                const double cPercentile)
+{
+    if (rcSamples.empty())
+    {
+        return 0;
+    }
+
+    auto idx = static_cast<std::size_t>(cPercentile * static_cast<double>(rcSamples.size() - 1));
+    return rcSamples[idx];
+}
+
+// Run the benchmark with a delete policy
+template<class TDeletePolicy>
+static void RunBenchmark(const char* pcName,
+                         const std::size_t cRequestCount,
+                         const std::size_t cNodeCount)
+{
+    FactoryInjector fi;
+    fi.RegisterFactory<GraphFactory<TDeletePolicy>>();
+
+    std::vector<std::uint64_t> latencies;
+    latencies.reserve(cRequestCount);
+
+    long sum = 0;
+    for (std::size_t i = 0; i < cRequestCount; i++)
+    {
+        auto start_time = tClock::now();
+        {
+            auto graph_ptr = fi.CreateObject<IGraphFactory<TDeletePolicy>>(cNodeCount);
+            sum += graph_ptr->Visit();
+        }
+        latencies.push_back(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(tClock::now() - start_time).count()));
+    }
+
+    // Measure the flush too, so that the total work is comparable
+    auto flush_start_time = tClock::now();
+    DeferredDelete::Flush();
+    auto flush_us = std::chrono::duration_cast<std::chrono::microseconds>(tClock::now() - flush_start_time).count();
+
+    std::sort(latencies.begin(), latencies.end());
+    std::printf("%-10s %12llu %12llu %12llu %12lld %8ld\n",
+                pcName,
+                static_cast<unsigned long long>(Percentile(latencies, 0.50)),
+                static_cast<unsigned long long>(Percentile(latencies, 0.99)),
+                static_cast<unsigned long long>(Percentile(latencies, 0.999)),
+                static_cast<long long>(flush_us),
+                sum % 10);
+}
+
+// Main function
+int main(int argc, char *argv[])
+{
+    std::size_t request_count = 100000;
+    std::size_t node_count    = 100;
+
+    // Parse command line
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::size_t value = std::strtoul(argv[i + 1], nullptr, 10);
+        if      (std::strcmp(argv[i], "--requests") == 0) { request_count = value; }
+        else if (std::strcmp(argv[i], "--nodes")    == 0) { node_count    = value; }
+        else
+        {
+            std::printf("Usage: %s [--requests N] [--nodes M]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::printf("%-10s %12s %12s %12s %12s %8s\n", "policy", "p50(ns)", "p99(ns)", "p999(ns)", "flush(us)", "check");
+
+    // Warm up the allocator before measuring
+    RunBenchmark<DefaultDelete>("warm-up", request_count / 10, node_count);
+
+    RunBenchmark<DefaultDelete>("default", request_count, node_count);
+    RunBenchmark<DeferredDelete>("deferred", request_count, node_count);
+
+    return 0;
+}
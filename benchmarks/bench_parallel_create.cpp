@@ -0,0 +1,192 @@
+/**
+ * Copyright (c) 2020 Emanuele Bellocchia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Parallel creation benchmark.
+ * It compares the time needed for creating many objects with a single-threaded CreateObject loop
+ * and with CreateObjectsParallel, for an increasing number of threads.
+ *
+ * Usage:
+ *   bench_parallel_create [--count N] [--threads T] [--payload P]
+ */
+
+/*
+ * Includes
+ */
+
+// Standard
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <thread>
+#include <vector>
+// Project
+#include "factory_injector.hpp"
+
+/*
+ * Using directives
+ */
+using namespace factory_injector;
+
+/*
+ * Types
+ */
+
+// Clock type
+using tClock = std::chrono::steady_clock;
+
+/*
+ * Classes
+ */
+
+// Benchmark object interface
+class IBenchObj
+{
+    public:
+      virtual ~IBenchObj(void)        = default;
+      virtual long Sum(void) const = 0;
+};
+
+// Benchmark object, it owns a payload that is allocated and initialized on creation
+class BenchObj : public IBenchObj
+{
+    public:
+      BenchObj(const std::size_t cSeed,
+               const std::size_t cPayloadSize) :
+        mPayload(cPayloadSize)
+      {
+          std::iota(mPayload.begin(), mPayload.end(), static_cast<long>(cSeed));
+      }
+
+      long Sum(void) const override
+      {
+          return std::accumulate(mPayload.begin(), mPayload.end(), 0L);
+      }
+
+    private:
+      std::vector<long> mPayload;
+};
+
+// Benchmark factory interface
+class IBenchObjFactory : public FactoryTraits<IBenchObjFactory, IBenchObj>
+{
+    public:
+      virtual ~IBenchObjFactory(void)                      = default;
+      virtual tObjectPtr Create(const std::size_t cSeed,
+                                const std::size_t cPayloadSize) const = 0;
+};
+
+// Benchmark factory
+class BenchObjFactory : public IBenchObjFactory
+{
+    public:
+      tObjectPtr Create(const std::size_t cSeed,
+                        const std::size_t cPayloadSize) const override
+      {
+          return std::make_unique<BenchObj>(cSeed, cPayloadSize);
+      }
+};
+
+/*
+ * Functions
+ */
+
+// Get elapsed milliseconds
+static double ElapsedMs(const tClock::time_point& rcStart)
+{
+    return std::chrono::duration<double, std::milli>(tClock::now() - rcStart).count();
+}
+
+// Main function
+int main(int argc, char *argv[])
+{
+    std::size_t count        = 200000;
+    std::size_t max_threads  = std::max(1u, std::thread::hardware_concurrency());
+    std::size_t payload_size = 32;
+
+    // Parse command line
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::size_t value = std::strtoul(argv[i + 1], nullptr, 10);
+        if      (std::strcmp(argv[i], "--count")   == 0) { count        = value; }
+        else if (std::strcmp(argv[i], "--threads") == 0) { max_threads  = std::max<std::size_t>(1, value); }
+        else if (std::strcmp(argv[i], "--payload") == 0) { payload_size = value; }
+        else
+        {
+            std::printf("Usage: %s [--count N] [--threads T] [--payload P]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    FactoryInjector fi;
+    fi.RegisterFactory<BenchObjFactory>();
+
+    // Single-threaded loop, used as reference
+    auto create_loop = [&]()
+    {
+        std::vector<IBenchObjFactory::tObjectPtr> objects;
+        objects.reserve(count);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            objects.push_back(fi.CreateObject<IBenchObjFactory>(i, payload_size));
+        }
+    };
+    // Warm up the allocator before measuring
+    create_loop();
+
+    auto start_time = tClock::now();
+    create_loop();
+    double reference_ms = ElapsedMs(start_time);
+
+    std::printf("%-22s %8s %12s %8s\n", "method", "threads", "time(ms)", "speedup");
+    std::printf("%-22s %8d %12.2f %8.2f\n", "CreateObject loop", 1, reference_ms, 1.0);
+
+    // Thread counts: powers of two up to the maximum, plus the maximum itself
+    std::vector<std::size_t> thread_counts;
+    for (std::size_t threads = 1; threads < max_threads; threads *= 2)
+    {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(max_threads);
+
+    // Parallel creation (objects destruction included, as for the reference)
+    auto get_args = [payload_size](std::size_t i) { return std::make_tuple(i, payload_size); };
+    for (auto threads : thread_counts)
+    {
+        // Warm up the pool workers and their allocator arenas before measuring
+        const ThreadExecutor executor(threads);
+        fi.CreateObjectsParallel<IBenchObjFactory>(count, get_args, executor);
+
+        start_time = tClock::now();
+        {
+            auto objects = fi.CreateObjectsParallel<IBenchObjFactory>(count, get_args, executor);
+        }
+        double parallel_ms = ElapsedMs(start_time);
+
+        std::printf("%-22s %8zu %12.2f %8.2f\n", "CreateObjectsParallel", threads, parallel_ms, reference_ms / parallel_ms);
+    }
+
+    return 0;
+}
@@ -0,0 +1,347 @@
+/**
+ * Copyright (c) 2020 Emanuele Bellocchia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Trace replay tool.
+ * It replays a trace recorded by TraceRecorder (see FactoryInjector::SetTraceRecorder) on a local injector,
+ * with the same sequence of events, the same threads and the same timing, so production load can be
+ * benchmarked offline. Recorded interfaces are mapped to synthetic factories, whose objects have
+ * a payload as large as the recorded arguments.
+ * It prints the recorded interfaces and, for each event type, the recorded and replayed latency percentiles.
+ * Replayed latencies cover only the factory operation, like the recorded ones (lock waits and object destruction excluded).
+ *
+ * Usage:
+ *   trace_replay FILE [--speed S]
+ *
+ * S scales the timing (e.g. 2 replays twice as fast), 0 replays as fast as possible. Default is 1.
+ */
+
+/*
+ * Includes
+ */
+
+// Standard
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+// Project
+#include "factory_injector.hpp"
+#include "trace_recorder.hpp"
+
+/*
+ * Using directives
+ */
+using namespace factory_injector;
+
+/*
+ * Types
+ */
+
+// Clock type
+using tClock = std::chrono::steady_clock;
+
+/*
+ * Constants
+ */
+
+// Number of synthetic factories, recorded interfaces exceeding it share them
+constexpr std::size_t kSlotCount = 64;
+// Number of event types
+constexpr std::size_t kEventTypeCount = 3;
+
+/*
+ * Classes
+ */
+
+// Synthetic object
+struct SlotObject
+{
+    explicit SlotObject(const std::size_t cPayloadSize) :
+        mPayload(cPayloadSize, 1)
+    {}
+
+    std::vector<char> mPayload;
+};
+
+// Synthetic factory interface
+template<std::size_t TSlot>
+class ISlotFactory
+{
+    public:
+      using tObjectPtr = std::unique_ptr<SlotObject>;
+
+      virtual ~ISlotFactory(void)                                       = default;
+      virtual tObjectPtr Create(const std::size_t cPayloadSize) const = 0;
+};
+
+// Synthetic factory
+template<std::size_t TSlot>
+class SlotFactory : public ISlotFactory<TSlot>
+{
+    public:
+      using tInterface = ISlotFactory<TSlot>;
+      using tObjectPtr = typename ISlotFactory<TSlot>::tObjectPtr;
+
+      tObjectPtr Create(const std::size_t cPayloadSize) const override
+      {
+          return std::make_unique<SlotObject>(cPayloadSize);
+      }
+};
+
+// Operations on a synthetic factory
+struct SlotOps
+{
+    void                        (*mpGet)(const FactoryInjector&);                   /**< GetFactory       */
+    std::unique_ptr<SlotObject> (*mpCreate)(const FactoryInjector&, std::size_t);   /**< CreateObject     */
+    void                        (*mpOverwrite)(FactoryInjector&);                   /**< OverwriteFactory */
+};
+
+// Replayed event
+struct ReplayEvent
+{
+    std::uint64_t  mOffsetNs;   /**< Offset from the earliest event */
+    std::size_t    mSlot;       /**< Synthetic factory slot         */
+    std::size_t    mArgBytes;   /**< Size of the arguments          */
+    TraceEventType mType;       /**< Event type                     */
+};
+
+/*
+ * Functions
+ */
+
+// Get the operations of a synthetic factory
+template<std::size_t TSlot>
+static SlotOps GetSlotOps(void)
+{
+    return SlotOps{
+        [](const FactoryInjector& rcFi) { rcFi.GetFactory<SlotFactory<TSlot>>(); },
+        [](const FactoryInjector& rcFi, std::size_t cArgBytes) { return rcFi.CreateObject<SlotFactory<TSlot>>(cArgBytes); },
+        [](FactoryInjector& rFi) { rFi.OverwriteFactory<SlotFactory<TSlot>>(); }
+    };
+}
+
+// Get the operations of all the synthetic factories
+template<std::size_t ... TSlots>
+static std::vector<SlotOps> GetAllSlotOps(std::index_sequence<TSlots...>)
+{
+    return { GetSlotOps<TSlots>()... };
+}
+
+// Get the latency percentile, samples shall be sorted
+static std::uint64_t Percentile(const std::vector<std::uint64_t>& rcSamples,
+                                const double cPercentile)
+{
+    if (rcSamples.empty())
+    {
+        return 0;
+    }
+
+    auto idx = static_cast<std::size_t>(cPercentile * static_cast<double>(rcSamples.size() - 1));
+    return rcSamples[idx];
+}
+
+// Print the latency percentiles of an event type
+static void PrintLatencies(const char* pcName,
+                           const char* pcSource,
+                           std::vector<std::uint64_t>& rLatencies)
+{
+    std::sort(rLatencies.begin(), rLatencies.end());
+    std::printf("%-18s %-9s %10zu %12llu %12llu %12llu\n",
+                pcName,
+                pcSource,
+                rLatencies.size(),
+                static_cast<unsigned long long>(Percentile(rLatencies, 0.50)),
+                static_cast<unsigned long long>(Percentile(rLatencies, 0.99)),
+                static_cast<unsigned long long>(Percentile(rLatencies, 0.999)));
+}
+
+// Main function
+int main(int argc, char *argv[])
+{
+    static const char* const kEventNames[kEventTypeCount] = { "GetFactory", "CreateObject", "OverwriteFactory" };
+
+    if (argc < 2)
+    {
+        std::printf("Usage: %s FILE [--speed S]\n", argv[0]);
+        return 1;
+    }
+
+    // Parse command line
+    double speed = 1.0;
+    for (int i = 2; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--speed") == 0) { speed = std::strtod(argv[i + 1], nullptr); }
+        else
+        {
+            std::printf("Usage: %s FILE [--speed S]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // Read trace
+    std::vector<TraceEvent> events;
+    std::map<std::uint64_t, std::string> names;
+    try
+    {
+        events = TraceReader::Read(argv[1]);
+        names  = TraceReader::ReadNames(argv[1]);
+    }
+    catch (const TraceFileEx& rcEx)
+    {
+        std::printf("%s\n", rcEx.what());
+        return 1;
+    }
+    if (events.empty())
+    {
+        std::printf("No events in trace\n");
+        return 1;
+    }
+
+    // Offsets are computed from the earliest event, since concurrent threads record events out of timestamp order
+    const std::uint64_t cStartNs = std::min_element(std::begin(events), std::end(events),
+                                                    [](const TraceEvent& rcLeft, const TraceEvent& rcRight) { return rcLeft.mTimestampNs < rcRight.mTimestampNs; })->mTimestampNs;
+
+    // Map interfaces to slots and events to threads, keeping the recorded latencies
+    std::map<std::uint64_t, std::size_t> slots;
+    std::map<std::uint64_t, std::size_t> interface_events;
+    std::map<std::uint16_t, std::vector<ReplayEvent>> thread_events;
+    std::vector<std::uint64_t> recorded_latencies[kEventTypeCount];
+    for (const auto& event : events)
+    {
+        auto slot_it = slots.emplace(event.mTypeId, slots.size() % kSlotCount).first;
+        interface_events[event.mTypeId]++;
+        thread_events[event.mThreadId].push_back(ReplayEvent{ event.mTimestampNs - cStartNs,
+                                                              slot_it->second,
+                                                              event.mArgBytes,
+                                                              event.mType });
+        recorded_latencies[static_cast<std::size_t>(event.mType)].push_back(event.mDurationNs);
+    }
+
+    // Register all the used slots, since the trace may start after registration
+    const auto slot_ops = GetAllSlotOps(std::make_index_sequence<kSlotCount>());
+    FactoryInjector fi;
+    for (std::size_t i = 0; i < std::min(slots.size(), kSlotCount); i++)
+    {
+        slot_ops[i].mpOverwrite(fi);
+    }
+
+    // Replay each thread, overwrites shall not run concurrently with lookups
+    std::shared_timed_mutex fi_mutex;
+    std::vector<std::vector<std::uint64_t>> replayed_latencies(thread_events.size() * kEventTypeCount);
+    std::vector<std::thread> threads;
+    const auto start_time = tClock::now();
+    std::size_t thread_idx = 0;
+    for (const auto& thread_it : thread_events)
+    {
+        threads.emplace_back([&, thread_idx](const std::vector<ReplayEvent>& rcEvents)
+        {
+            for (const auto& event : rcEvents)
+            {
+                if (speed > 0)
+                {
+                    std::this_thread::sleep_until(start_time + std::chrono::nanoseconds(static_cast<std::uint64_t>(static_cast<double>(event.mOffsetNs) / speed)));
+                }
+
+                // Only the operation is timed, like the recorded events: the lock is taken before starting the timer
+                // and the created object is destroyed after stopping it
+                const auto& ops = slot_ops[event.mSlot];
+                std::unique_ptr<SlotObject> obj_ptr;
+                tClock::time_point event_start_time;
+                tClock::time_point event_end_time;
+                switch (event.mType)
+                {
+                    case TraceEventType::GetFactory:
+                    {
+                        std::shared_lock<std::shared_timed_mutex> lock(fi_mutex);
+                        event_start_time = tClock::now();
+                        ops.mpGet(fi);
+                        event_end_time = tClock::now();
+                        break;
+                    }
+                    case TraceEventType::CreateObject:
+                    {
+                        std::shared_lock<std::shared_timed_mutex> lock(fi_mutex);
+                        event_start_time = tClock::now();
+                        obj_ptr = ops.mpCreate(fi, event.mArgBytes);
+                        event_end_time = tClock::now();
+                        break;
+                    }
+                    case TraceEventType::OverwriteFactory:
+                    {
+                        std::unique_lock<std::shared_timed_mutex> lock(fi_mutex);
+                        event_start_time = tClock::now();
+                        ops.mpOverwrite(fi);
+                        event_end_time = tClock::now();
+                        break;
+                    }
+                }
+                obj_ptr.reset();
+                replayed_latencies[(thread_idx * kEventTypeCount) + static_cast<std::size_t>(event.mType)].push_back(
+                    static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(event_end_time - event_start_time).count()));
+            }
+        }, std::cref(thread_it.second));
+        thread_idx++;
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    const auto replay_ms = std::chrono::duration_cast<std::chrono::milliseconds>(tClock::now() - start_time).count();
+
+    // Print results
+    std::printf("events: %zu, threads: %zu, interfaces: %zu, replay time: %lld ms\n",
+                events.size(), thread_events.size(), slots.size(), static_cast<long long>(replay_ms));
+    for (const auto& interface_it : interface_events)
+    {
+        const auto name_it = names.find(interface_it.first);
+        std::printf("interface %016llx %-40s %10zu events\n",
+                    static_cast<unsigned long long>(interface_it.first),
+                    (name_it != names.end()) ? name_it->second.c_str() : "(unknown)",
+                    interface_it.second);
+    }
+    std::printf("%-18s %-9s %10s %12s %12s %12s\n", "event", "source", "count", "p50(ns)", "p99(ns)", "p999(ns)");
+    for (std::size_t type = 0; type < kEventTypeCount; type++)
+    {
+        std::vector<std::uint64_t> latencies;
+        for (std::size_t i = 0; i < thread_events.size(); i++)
+        {
+            const auto& thread_latencies = replayed_latencies[(i * kEventTypeCount) + type];
+            latencies.insert(latencies.end(), thread_latencies.begin(), thread_latencies.end());
+        }
+
+        PrintLatencies(kEventNames[type], "recorded", recorded_latencies[type]);
+        PrintLatencies(kEventNames[type], "replayed", latencies);
+    }
+
+    return 0;
+}
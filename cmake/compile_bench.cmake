@@ -0,0 +1,86 @@
+# Copyright (c) 2020 Emanuele Bellocchia
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+#
+# Compile-time benchmark.
+# It generates FACTORY_INJECTOR_COMPILE_BENCH_INTERFACES factory interfaces, each one with a concrete
+# factory, and FACTORY_INJECTOR_COMPILE_BENCH_TUS translation units that register and use all of them.
+# The compile_bench target builds them as a normal executable, while compile_bench_report compiles each
+# translation unit on its own and reports compile time and object size.
+#
+
+# Output folder for generated files
+set (COMPILE_BENCH_DIR ${CMAKE_BINARY_DIR}/compile_bench)
+set (COMPILE_BENCH_N   ${FACTORY_INJECTOR_COMPILE_BENCH_INTERFACES})
+set (COMPILE_BENCH_M   ${FACTORY_INJECTOR_COMPILE_BENCH_TUS})
+
+# Header with interfaces and factories
+set (COMPILE_BENCH_HDR "#ifndef _COMPILE_BENCH_INTERFACES_HPP_\n#define _COMPILE_BENCH_INTERFACES_HPP_\n\n")
+string (APPEND COMPILE_BENCH_HDR "#include <factory_injector.hpp>\n\nnamespace compile_bench\n{\n\n")
+math (EXPR COMPILE_BENCH_LAST_IF "${COMPILE_BENCH_N} - 1")
+foreach (IF_IDX RANGE ${COMPILE_BENCH_LAST_IF})
+    string (APPEND COMPILE_BENCH_HDR
+            "class IObj${IF_IDX}\n{\n    public:\n        virtual ~IObj${IF_IDX}(void) = default;\n        virtual int Get(void) const = 0;\n};\n\n"
+            "class Obj${IF_IDX} : public IObj${IF_IDX}\n{\n    public:\n        Obj${IF_IDX}(const int cValue) : mValue(cValue) {}\n        int Get(void) const override { return mValue + ${IF_IDX}; }\n    private:\n        int mValue;\n};\n\n"
+            "class IObj${IF_IDX}Factory : public factory_injector::FactoryTraits<IObj${IF_IDX}Factory, IObj${IF_IDX}>\n{\n    public:\n        virtual ~IObj${IF_IDX}Factory(void) = default;\n        virtual tObjectPtr Create(const int cValue) const = 0;\n};\n\n"
+            "class Obj${IF_IDX}Factory : public IObj${IF_IDX}Factory\n{\n    public:\n        tObjectPtr Create(const int cValue) const override { return std::make_unique<Obj${IF_IDX}>(cValue); }\n};\n\n")
+endforeach ()
+string (APPEND COMPILE_BENCH_HDR "}   // namespace compile_bench\n\n#endif  // _COMPILE_BENCH_INTERFACES_HPP_\n")
+file (WRITE ${COMPILE_BENCH_DIR}/interfaces.hpp "${COMPILE_BENCH_HDR}")
+
+# Translation units, each one overwrites, gets and creates from all the factories
+set (COMPILE_BENCH_SRCS)
+set (COMPILE_BENCH_MAIN "#include <factory_injector.hpp>\n\n")
+set (COMPILE_BENCH_CALLS)
+math (EXPR COMPILE_BENCH_LAST_TU "${COMPILE_BENCH_M} - 1")
+foreach (TU_IDX RANGE ${COMPILE_BENCH_LAST_TU})
+    set (COMPILE_BENCH_TU "#include \"interfaces.hpp\"\n\nint CompileBenchTu${TU_IDX}(factory_injector::FactoryInjector& rFactoryInjector)\n{\n    int sum = 0;\n")
+    foreach (IF_IDX RANGE ${COMPILE_BENCH_LAST_IF})
+        string (APPEND COMPILE_BENCH_TU
+                "    rFactoryInjector.OverwriteFactory<compile_bench::Obj${IF_IDX}Factory>();\n"
+                "    sum += rFactoryInjector.GetFactory<compile_bench::IObj${IF_IDX}Factory>().Create(${TU_IDX})->Get();\n"
+                "    sum += rFactoryInjector.CreateObject<compile_bench::IObj${IF_IDX}Factory>(${TU_IDX})->Get();\n")
+    endforeach ()
+    string (APPEND COMPILE_BENCH_TU "    return sum;\n}\n")
+    file (WRITE ${COMPILE_BENCH_DIR}/tu_${TU_IDX}.cpp "${COMPILE_BENCH_TU}")
+    list (APPEND COMPILE_BENCH_SRCS ${COMPILE_BENCH_DIR}/tu_${TU_IDX}.cpp)
+    string (APPEND COMPILE_BENCH_MAIN "int CompileBenchTu${TU_IDX}(factory_injector::FactoryInjector& rFactoryInjector);\n")
+    string (APPEND COMPILE_BENCH_CALLS "    sum += CompileBenchTu${TU_IDX}(fi);\n")
+endforeach ()
+string (APPEND COMPILE_BENCH_MAIN "\nint main(void)\n{\n    factory_injector::FactoryInjector fi;\n    int sum = 0;\n${COMPILE_BENCH_CALLS}    return (sum != 0) ? 0 : 1;\n}\n")
+file (WRITE ${COMPILE_BENCH_DIR}/main.cpp "${COMPILE_BENCH_MAIN}")
+
+# Benchmark executable
+add_executable (compile_bench
+                ${COMPILE_BENCH_DIR}/main.cpp
+                ${COMPILE_BENCH_SRCS})
+# Set compiler options
+target_compile_options (compile_bench PRIVATE -O2 -std=c++17)
+
+# Report target, it compiles each translation unit separately and measures it
+add_custom_target (compile_bench_report
+                   COMMAND ${CMAKE_COMMAND}
+                           -DCOMPILER=${CMAKE_CXX_COMPILER}
+                           -DINCLUDE_DIR=${PROJECT_SOURCE_DIR}/src
+                           -DBENCH_DIR=${COMPILE_BENCH_DIR}
+                           -DTU_COUNT=${COMPILE_BENCH_M}
+                           -DIF_COUNT=${COMPILE_BENCH_N}
+                           -P ${PROJECT_SOURCE_DIR}/cmake/compile_bench_report.cmake
+                   VERBATIM)
@@ -0,0 +1,60 @@
+# Copyright (c) 2020 Emanuele Bellocchia
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+#
+# Compile-time benchmark report script, invoked by the compile_bench_report target.
+# It compiles each generated translation unit and writes compile time and object size to
+# BENCH_DIR/report.csv, so that results of different revisions can be compared.
+#
+
+set (REPORT_FILE  ${BENCH_DIR}/report.csv)
+set (OBJ_DIR      ${BENCH_DIR}/report_obj)
+set (TOTAL_US     0)
+set (TOTAL_BYTES  0)
+
+file (MAKE_DIRECTORY ${OBJ_DIR})
+file (WRITE ${REPORT_FILE} "tu,interfaces,compile_us,object_bytes\n")
+
+math (EXPR LAST_TU "${TU_COUNT} - 1")
+foreach (TU_IDX RANGE ${LAST_TU})
+    set (OBJ_FILE ${OBJ_DIR}/tu_${TU_IDX}.o)
+
+    # Compile and measure
+    string (TIMESTAMP START_US "%s%f")
+    execute_process (COMMAND ${COMPILER} -O2 -std=c++17 -I${INCLUDE_DIR} -c ${BENCH_DIR}/tu_${TU_IDX}.cpp -o ${OBJ_FILE}
+                     RESULT_VARIABLE COMPILE_RES)
+    string (TIMESTAMP STOP_US "%s%f")
+    if (NOT COMPILE_RES EQUAL 0)
+        message (FATAL_ERROR "Unable to compile tu_${TU_IDX}.cpp")
+    endif ()
+
+    math (EXPR ELAPSED_US "${STOP_US} - ${START_US}")
+    file (SIZE ${OBJ_FILE} OBJ_BYTES)
+    math (EXPR TOTAL_US    "${TOTAL_US} + ${ELAPSED_US}")
+    math (EXPR TOTAL_BYTES "${TOTAL_BYTES} + ${OBJ_BYTES}")
+    file (APPEND ${REPORT_FILE} "${TU_IDX},${IF_COUNT},${ELAPSED_US},${OBJ_BYTES}\n")
+endforeach ()
+
+math (EXPR AVG_US    "${TOTAL_US} / ${TU_COUNT}")
+math (EXPR AVG_BYTES "${TOTAL_BYTES} / ${TU_COUNT}")
+message (STATUS "Compile bench: ${TU_COUNT} translation units x ${IF_COUNT} interfaces")
+message (STATUS "  Total compile time : ${TOTAL_US} us (average ${AVG_US} us per translation unit)")
+message (STATUS "  Total object size  : ${TOTAL_BYTES} bytes (average ${AVG_BYTES} bytes per translation unit)")
+message (STATUS "  Report written to  : ${REPORT_FILE}")
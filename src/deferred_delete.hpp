@@ -0,0 +1,547 @@
+/**
+ * @copyright Copyright (c) 2020 Emanuele Bellocchia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file  deferred_delete.hpp
+ * @brief Deferred delete policy for factories: objects are destroyed by a background thread instead of the thread releasing them
+ *
+ */
+
+#ifndef _FACTORY_INJECTOR_DEFERRED_DELETE_HPP_
+#define _FACTORY_INJECTOR_DEFERRED_DELETE_HPP_
+
+/*
+ * Includes
+ */
+
+// Standard
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+// Project
+#include "not_copyable_movable.hpp"
+
+/*
+ * Namespaces
+ */
+namespace factory_injector
+{
+
+/* Internal namespace, shall not be used */
+namespace deferred_details
+{
+
+/** Number of objects of each retire queue, when full objects are deleted immediately */
+constexpr std::size_t kQueueSize = 4096;
+/** Cache line size, for keeping the queue indexes on different cache lines */
+constexpr std::size_t kCacheLineSize = 64;
+/** Reclaimer period, for batching the objects retired after the reclaimer is woken up */
+constexpr std::chrono::milliseconds kReclaimPeriod(1);
+
+/**
+ * @brief Retired object
+ */
+struct RetiredObject
+{
+    void  *mpObject;                /**< Object pointer      */
+    void (*mpDeleter)(void *);      /**< Object deleter      */
+};
+
+/**
+ * @brief Retire queue of a thread.
+ *        It's a lock-free single-producer (the owning thread) single-consumer (the reclaimer) ring buffer.
+ */
+class RetireQueue : public NotCopyMovable
+{
+    /*
+     * Public methods
+     */
+    public:
+        /**
+         * @brief     Push an object (producer only)
+         * @param[in] rcObject Retired object
+         * @return    True if pushed, false if the queue is full
+         */
+        bool Push(const RetiredObject& rcObject)
+        {
+            const std::size_t tail = mTail.load(std::memory_order_relaxed);
+            if (tail - mHead.load(std::memory_order_acquire) == kQueueSize)
+            {
+                return false;
+            }
+
+            mObjects[tail % kQueueSize] = rcObject;
+            mTail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief  Delete all the pushed objects (consumer only)
+         * @return void
+         */
+        void Drain(void)
+        {
+            const std::size_t head = mHead.load(std::memory_order_relaxed);
+            const std::size_t tail = mTail.load(std::memory_order_acquire);
+            for (std::size_t i = head; i != tail; i++)
+            {
+                const RetiredObject& object = mObjects[i % kQueueSize];
+                object.mpDeleter(object.mpObject);
+            }
+            mHead.store(tail, std::memory_order_release);
+        }
+
+        /**
+         * @brief  Get if the queue is empty (consumer only)
+         * @return True if empty, false otherwise
+         */
+        bool IsEmpty(void) const
+        {
+            return mHead.load(std::memory_order_relaxed) == mTail.load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief  Set the queue as orphaned, when its thread exits (producer only)
+         * @return void
+         */
+        void SetOrphaned(void)
+        {
+            mOrphaned.store(true, std::memory_order_release);
+        }
+
+        /**
+         * @brief  Get if the queue is orphaned, i.e. nothing will be pushed anymore
+         * @return True if orphaned, false otherwise
+         */
+        bool IsOrphaned(void) const
+        {
+            return mOrphaned.load(std::memory_order_acquire);
+        }
+
+    /*
+     * Members
+     */
+    private:
+        alignas(kCacheLineSize) std::atomic<std::size_t> mHead{0};              /**< Consumer index   */
+        alignas(kCacheLineSize) std::atomic<std::size_t> mTail{0};              /**< Producer index   */
+        alignas(kCacheLineSize) std::atomic<bool>        mOrphaned{false};      /**< Orphaned flag    */
+        RetiredObject                                    mObjects[kQueueSize];  /**< Objects          */
+};
+
+/**
+ * @brief  Get the shutdown flag, set when the reclaimer is destroyed (objects are deleted immediately afterwards).
+ *         It's constant-initialized and trivially destructible, so it can be used at any time.
+ * @return Shutdown flag
+ */
+inline std::atomic<bool>& GetShutdownFlag(void)
+{
+    static std::atomic<bool> shutdown_flag{false};
+
+    return shutdown_flag;
+}
+
+/**
+ * @brief  Get the draining flag of the current thread.
+ *         Objects released while draining (e.g. members of deleted objects) are deleted immediately.
+ * @return Draining flag
+ */
+inline bool& GetDrainingFlag(void)
+{
+    thread_local bool draining_flag = false;
+
+    return draining_flag;
+}
+
+/**
+ * @brief  Get the destroyed flag of the queue holder of the current thread.
+ *         It's trivially destructible, so it can be read also after the holder is destroyed during the thread exit.
+ * @return Destroyed flag
+ */
+inline bool& GetHolderDestroyedFlag(void)
+{
+    thread_local bool destroyed_flag = false;
+
+    return destroyed_flag;
+}
+
+/**
+ * @brief Reclaimer, it deletes the objects of all the retire queues in a background thread.
+ *        The thread sleeps while all the queues are empty and it's woken up by the first object retired afterwards,
+ *        then it deletes the retired objects in batches, once per period, until the queues are empty again.
+ */
+class Reclaimer : public NotCopyMovable
+{
+    /*
+     * Types
+     */
+    private:
+        /** Queue pointer type definition */
+        using tQueuePtr = std::shared_ptr<RetireQueue>;
+
+    /*
+     * Public methods
+     */
+    public:
+        /**
+         * @brief  Get the reclaimer, it's started on first use
+         * @return Reclaimer reference
+         */
+        static Reclaimer& Get(void)
+        {
+            static Reclaimer reclaimer;
+
+            return reclaimer;
+        }
+
+        /**
+         * @brief Destructor, it stops the background thread and deletes all the remaining objects
+         */
+        ~Reclaimer(void)
+        {
+            GetShutdownFlag().store(true);
+            {
+                std::lock_guard<std::mutex> lock(mWakeMutex);
+                mStop = true;
+            }
+            mWakeCond.notify_one();
+            mThread.join();
+
+            Flush();
+        }
+
+        /**
+         * @brief     Register a retire queue
+         * @param[in] queuePtr Queue pointer
+         * @return    void
+         */
+        void Register(tQueuePtr queuePtr)
+        {
+            std::lock_guard<std::mutex> lock(mQueuesMutex);
+            mQueues.push_back(std::move(queuePtr));
+        }
+
+        /**
+         * @brief  Notify that an object was retired, it wakes up the background thread if it's sleeping.
+         *         It shall be called after pushing the object.
+         * @return void
+         */
+        void NotifyRetired(void)
+        {
+            // Paired with the fence in Run: either this thread sees the sleeping flag, or the background thread sees the object
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (mSleeping.load(std::memory_order_relaxed))
+            {
+                Wake();
+            }
+        }
+
+        /**
+         * @brief  Wake up the background thread (e.g. when a queue is full)
+         * @return void
+         */
+        void Wake(void)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mWakeMutex);
+                mWake = true;
+            }
+            mWakeCond.notify_one();
+        }
+
+        /**
+         * @brief  Delete all the objects retired so far, by any thread.
+         *         Objects retired by the calling thread are always deleted.
+         *         If it's called while deleting objects (e.g. by a destructor run by the background thread), it returns
+         *         immediately: the objects being deleted cannot wait for their own deletion to finish.
+         * @return void
+         */
+        void Flush(void)
+        {
+            if (GetDrainingFlag())
+            {
+                return;
+            }
+
+            // The queues are single-consumer, so only one thread drains them at a time.
+            // Each queue is taken under the queues lock, but it's drained without it, so the deleters don't block
+            // the threads registering their first queue. Queues are only appended meanwhile, so indexes stay valid.
+            std::lock_guard<std::mutex> drain_lock(mDrainMutex);
+
+            GetDrainingFlag() = true;
+            std::size_t queue_idx = 0;
+            while (true)
+            {
+                tQueuePtr queue_ptr;
+                {
+                    std::lock_guard<std::mutex> lock(mQueuesMutex);
+                    if (queue_idx == mQueues.size())
+                    {
+                        break;
+                    }
+                    queue_ptr = mQueues[queue_idx];
+                }
+
+                // An orphaned queue is empty after draining, since nothing can be pushed to it anymore
+                const bool cOrphaned = queue_ptr->IsOrphaned();
+                queue_ptr->Drain();
+
+                std::lock_guard<std::mutex> lock(mQueuesMutex);
+                if (cOrphaned)
+                {
+                    mQueues.erase(std::next(std::begin(mQueues), static_cast<std::ptrdiff_t>(queue_idx)));
+                }
+                else
+                {
+                    queue_idx++;
+                }
+            }
+            GetDrainingFlag() = false;
+        }
+
+    /*
+     * Private methods
+     */
+    private:
+        /**
+         * @brief Constructor
+         */
+        Reclaimer(void) :
+            mThread(&Reclaimer::Run, this)
+        {}
+
+        /**
+         * @brief  Get if all the queues are empty
+         * @return True if empty, false otherwise
+         */
+        bool AreQueuesEmpty(void)
+        {
+            std::lock_guard<std::mutex> lock(mQueuesMutex);
+
+            return std::all_of(std::begin(mQueues), std::end(mQueues), [](const tQueuePtr& rcQueuePtr) { return rcQueuePtr->IsEmpty(); });
+        }
+
+        /**
+         * @brief  Background thread function
+         * @return void
+         */
+        void Run(void)
+        {
+            std::unique_lock<std::mutex> lock(mWakeMutex);
+            while (!mStop)
+            {
+                // Sleep until an object is retired, unless some objects were retired meanwhile
+                mSleeping.store(true, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (AreQueuesEmpty())
+                {
+                    mWakeCond.wait(lock, [this]() { return mStop || mWake; });
+                }
+                mSleeping.store(false, std::memory_order_relaxed);
+                mWake = false;
+
+                // Wait for the period, so that the objects retired meanwhile are deleted in the same batch
+                mWakeCond.wait_for(lock, kReclaimPeriod, [this]() { return mStop; });
+
+                lock.unlock();
+                Flush();
+                lock.lock();
+            }
+        }
+
+    /*
+     * Members
+     */
+    private:
+        std::mutex              mDrainMutex;        /**< Drain mutex, held while draining (one consumer)  */
+        std::mutex              mQueuesMutex;       /**< Queues mutex                                     */
+        std::vector<tQueuePtr>  mQueues;            /**< Registered queues                                */
+        std::mutex              mWakeMutex;         /**< Wake-up mutex                                    */
+        std::condition_variable mWakeCond;          /**< Wake-up condition                                */
+        std::atomic<bool>       mSleeping{false};   /**< Sleeping flag                                    */
+        bool                    mWake = false;      /**< Wake-up flag                                     */
+        bool                    mStop = false;      /**< Stop flag                                        */
+        std::thread             mThread;            /**< Background thread                                */
+};
+
+/**
+ * @brief Holder of the retire queue of a thread, it orphans the queue when the thread exits
+ */
+class QueueHolder : public NotCopyMovable
+{
+    /*
+     * Public methods
+     */
+    public:
+        /**
+         * @brief Constructor, it registers the queue to the reclaimer
+         */
+        QueueHolder(void) :
+            mQueuePtr(std::make_shared<RetireQueue>())
+        {
+            Reclaimer::Get().Register(mQueuePtr);
+        }
+
+        /**
+         * @brief Destructor, objects released afterwards by the thread (e.g. by other thread-local destructors)
+         *        are deleted immediately
+         */
+        ~QueueHolder(void)
+        {
+            mQueuePtr->SetOrphaned();
+            GetHolderDestroyedFlag() = true;
+        }
+
+        /**
+         * @brief  Get the queue
+         * @return Queue reference
+         */
+        RetireQueue& GetQueue(void)
+        {
+            return *mQueuePtr;
+        }
+
+    /*
+     * Members
+     */
+    private:
+        std::shared_ptr<RetireQueue> mQueuePtr;     /**< Queue pointer */
+};
+
+/**
+ * @brief     Retire an object, it's deleted immediately if the queue of the current thread is full (backpressure),
+ *            while draining, after the queue of the current thread is destroyed or after shutdown
+ * @param[in] pObject   Object pointer
+ * @param[in] pDeleter  Object deleter
+ * @return    void
+ */
+inline void Retire(void *pObject,
+                   void (*pDeleter)(void *))
+{
+    if (GetDrainingFlag() || GetHolderDestroyedFlag() || GetShutdownFlag().load(std::memory_order_relaxed))
+    {
+        pDeleter(pObject);
+        return;
+    }
+
+    thread_local QueueHolder queue_holder;
+    if (queue_holder.GetQueue().Push(RetiredObject{ pObject, pDeleter }))
+    {
+        Reclaimer::Get().NotifyRetired();
+    }
+    else
+    {
+        Reclaimer::Get().Wake();
+        pDeleter(pObject);
+    }
+}
+
+}   // namespace deferred_details
+
+/**
+ * @brief  Deferred deleter, it retires objects to the queue of the current thread, so that they're deleted by a
+ *         background thread. It can be implicitly constructed from std::default_delete, so factories can keep returning
+ *         std::make_unique results.
+ * @tparam TObject Object type
+ */
+template<class TObject>
+class DeferredDeleter
+{
+    /*
+     * Public methods
+     */
+    public:
+        /**
+         * @brief Constructor
+         */
+        DeferredDeleter(void) noexcept = default;
+
+        /**
+         * @brief     Constructor from the default deleter of a derived type
+         * @param[in] rcDeleter Default deleter
+         * @tparam    TDerived  Derived object type
+         */
+        template<class TDerived,
+                 std::enable_if_t<std::is_convertible<TDerived *, TObject *>::value, int> = 0>
+        DeferredDeleter(const std::default_delete<TDerived>& rcDeleter) noexcept
+        {
+            static_cast<void>(rcDeleter);
+        }
+
+        /**
+         * @brief     Constructor from the deferred deleter of a derived type
+         * @param[in] rcDeleter Deferred deleter
+         * @tparam    TDerived  Derived object type
+         */
+        template<class TDerived,
+                 std::enable_if_t<std::is_convertible<TDerived *, TObject *>::value, int> = 0>
+        DeferredDeleter(const DeferredDeleter<TDerived>& rcDeleter) noexcept
+        {
+            static_cast<void>(rcDeleter);
+        }
+
+        /**
+         * @brief     Retire the object
+         * @param[in] pObject Object pointer
+         * @return    void
+         */
+        void operator()(TObject *pObject) const
+        {
+            static_assert(sizeof(TObject) > 0, "The object type shall be complete");
+
+            deferred_details::Retire(pObject, [](void *pRetired) { delete static_cast<TObject *>(pRetired); });
+        }
+};
+
+/**
+ * @brief Deferred delete policy for factories.
+ *        Objects released by a thread are put in its lock-free retire queue and a background thread deletes them
+ *        in batches, so that their destruction doesn't add latency to the releasing thread.
+ *        If the queue is full, objects are deleted immediately by the releasing thread.
+ */
+struct DeferredDelete
+{
+    /** Deleter type definition */
+    template<class TObject>
+    using tDeleter = DeferredDeleter<TObject>;
+
+    /**
+     * @brief  Delete all the objects retired so far (e.g. for an orderly shutdown).
+     *         Objects retired by the calling thread are always deleted, objects retired by other threads
+     *         are deleted if their release happened before this call.
+     *         It shall not be called by the destructors of deferred objects: in that case it returns immediately.
+     * @return void
+     */
+    static void Flush(void)
+    {
+        deferred_details::Reclaimer::Get().Flush();
+    }
+};
+
+}   // namespace factory_injector
+
+#endif  // _FACTORY_INJECTOR_DEFERRED_DELETE_HPP_
@@ -0,0 +1,301 @@
+/**
+ * @copyright Copyright (c) 2020 Emanuele Bellocchia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file  factory_accounting.hpp
+ * @brief Live-object and memory accounting for objects created by factories.
+ *        It's compiled in only if FACTORY_INJECTOR_ENABLE_ACCOUNTING is defined, which shall be done
+ *        consistently for the whole program since it changes the object pointer type.
+ *
+ */
+
+#ifndef _FACTORY_INJECTOR_FACTORY_ACCOUNTING_HPP_
+#define _FACTORY_INJECTOR_FACTORY_ACCOUNTING_HPP_
+
+/*
+ * Includes
+ */
+
+// Standard
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+/*
+ * Namespaces
+ */
+namespace factory_injector
+{
+
+/* Internal namespace, shall not be used */
+namespace accounting_details
+{
+
+/** Number of counter shards, each thread updates only one of them */
+constexpr std::size_t kShardCount = 16;
+
+/**
+ * @brief Counters of a single factory interface.
+ *        They are sharded by thread and each shard is aligned to a cache line, so that threads creating
+ *        and destroying objects concurrently do not contend on the same cache line.
+ */
+class InterfaceCounters
+{
+    /*
+     * Types
+     */
+    private:
+        /**
+         * @brief Counters shard
+         */
+        struct alignas(64) Shard
+        {
+            std::atomic<std::int64_t> mLiveObjects{0};      /**< Live objects    */
+            std::atomic<std::int64_t> mCreatedObjects{0};   /**< Created objects */
+            std::atomic<std::int64_t> mLiveBytes{0};        /**< Live bytes      */
+            std::atomic<std::int64_t> mCreatedBytes{0};     /**< Created bytes   */
+        };
+
+    /*
+     * Public methods
+     */
+    public:
+        /**
+         * @brief     Account for a created object
+         * @param[in] cSize Object size in bytes
+         * @return    void
+         */
+        void OnCreated(const std::size_t cSize)
+        {
+            auto& shard = GetShard();
+            shard.mLiveObjects.fetch_add(1, std::memory_order_relaxed);
+            shard.mCreatedObjects.fetch_add(1, std::memory_order_relaxed);
+            shard.mLiveBytes.fetch_add(static_cast<std::int64_t>(cSize), std::memory_order_relaxed);
+            shard.mCreatedBytes.fetch_add(static_cast<std::int64_t>(cSize), std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief     Account for a destroyed object
+         * @param[in] cSize Object size in bytes
+         * @return    void
+         */
+        void OnDestroyed(const std::size_t cSize)
+        {
+            auto& shard = GetShard();
+            shard.mLiveObjects.fetch_sub(1, std::memory_order_relaxed);
+            shard.mLiveBytes.fetch_sub(static_cast<std::int64_t>(cSize), std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief  Get live objects
+         * @return Live objects
+         */
+        std::int64_t GetLiveObjects(void) const
+        {
+            return Sum(&Shard::mLiveObjects);
+        }
+
+        /**
+         * @brief  Get created objects
+         * @return Created objects
+         */
+        std::int64_t GetCreatedObjects(void) const
+        {
+            return Sum(&Shard::mCreatedObjects);
+        }
+
+        /**
+         * @brief  Get live bytes
+         * @return Live bytes
+         */
+        std::int64_t GetLiveBytes(void) const
+        {
+            return Sum(&Shard::mLiveBytes);
+        }
+
+        /**
+         * @brief  Get created bytes
+         * @return Created bytes
+         */
+        std::int64_t GetCreatedBytes(void) const
+        {
+            return Sum(&Shard::mCreatedBytes);
+        }
+
+    /*
+     * Private methods
+     */
+    private:
+        /**
+         * @brief  Get the shard of the current thread
+         * @return Shard reference
+         */
+        Shard& GetShard(void)
+        {
+            thread_local const std::size_t shard_idx = std::hash<std::thread::id>()(std::this_thread::get_id()) % kShardCount;
+
+            return mShards[shard_idx];
+        }
+
+        /**
+         * @brief     Sum a counter over all the shards
+         * @param[in] pCounter Pointer to the counter member
+         * @return    Sum
+         */
+        std::int64_t Sum(std::atomic<std::int64_t> Shard::*pCounter) const
+        {
+            std::int64_t sum = 0;
+            for (const auto& shard : mShards)
+            {
+                sum += (shard.*pCounter).load(std::memory_order_relaxed);
+            }
+            return sum;
+        }
+
+    /*
+     * Members
+     */
+    private:
+        Shard mShards[kShardCount];     /**< Counter shards */
+};
+
+/**
+ * @brief  Get the counters of a factory interface.
+ *         They are never destroyed before the objects, since they live until the end of the program.
+ * @tparam TInterface Interface type
+ * @return Counters reference
+ */
+template<class TInterface>
+InterfaceCounters& GetInterfaceCounters(void)
+{
+    static InterfaceCounters counters;
+
+    return counters;
+}
+
+}   // namespace accounting_details
+
+/**
+ * @brief  Deleter for objects created by factories when accounting is enabled.
+ *         It can be implicitly constructed from std::default_delete, so factories can keep returning
+ *         std::make_unique results, and it remembers the size of the created object.
+ *         Objects are accounted only when created by FactoryInjector::CreateObject.
+ *         They are accounted as destroyed immediately, then they are deleted by the underlying deleter.
+ * @tparam TObject  Object type
+ * @tparam TDeleter Underlying deleter type
+ */
+template<class TObject, class TDeleter = std::default_delete<TObject>>
+class AccountingDeleter
+{
+    /*
+     * Friend classes
+     */
+    template<class, class> friend class AccountingDeleter;
+
+    /*
+     * Public methods
+     */
+    public:
+        /**
+         * @brief Constructor
+         */
+        AccountingDeleter(void) noexcept = default;
+
+        /**
+         * @brief     Constructor from the default deleter of a derived type
+         * @param[in] rcDeleter Default deleter
+         * @tparam    TDerived  Derived object type
+         */
+        template<class TDerived,
+                 std::enable_if_t<std::is_convertible<TDerived *, TObject *>::value, int> = 0>
+        AccountingDeleter(const std::default_delete<TDerived>& rcDeleter) noexcept :
+            mDeleter(rcDeleter),
+            mSize(sizeof(TDerived))
+        {}
+
+        /**
+         * @brief     Constructor from the accounting deleter of a derived type
+         * @param[in] rcDeleter       Accounting deleter
+         * @tparam    TDerived        Derived object type
+         * @tparam    TDerivedDeleter Underlying deleter type of the derived object
+         */
+        template<class TDerived, class TDerivedDeleter,
+                 std::enable_if_t<std::is_convertible<TDerived *, TObject *>::value, int> = 0>
+        AccountingDeleter(const AccountingDeleter<TDerived, TDerivedDeleter>& rcDeleter) noexcept :
+            mDeleter(rcDeleter.mDeleter),
+            mpCounters(rcDeleter.mpCounters),
+            mSize(rcDeleter.mSize)
+        {}
+
+        /**
+         * @brief     Start accounting the object
+         * @param[in] rCounters Interface counters
+         * @return    void
+         */
+        void Track(accounting_details::InterfaceCounters& rCounters)
+        {
+            mpCounters = &rCounters;
+            mpCounters->OnCreated(mSize);
+        }
+
+        /**
+         * @brief     Delete the object
+         * @param[in] pObject Object pointer
+         * @return    void
+         */
+        void operator()(TObject *pObject) const
+        {
+            if (mpCounters != nullptr)
+            {
+                mpCounters->OnDestroyed(mSize);
+            }
+            mDeleter(pObject);
+        }
+
+    /*
+     * Members
+     */
+    private:
+        TDeleter                               mDeleter;                      /**< Underlying deleter                      */
+        accounting_details::InterfaceCounters *mpCounters = nullptr;          /**< Interface counters, null if not tracked */
+        std::size_t                            mSize      = sizeof(TObject);  /**< Object size                             */
+};
+
+/**
+ * @brief Accounting information of a factory interface
+ */
+struct FactoryAccountingInfo
+{
+    std::string  mInterfaceName;        /**< Factory interface name                                      */
+    std::int64_t mLiveObjects;          /**< Objects created by CreateObject and still alive             */
+    std::int64_t mCreatedObjects;       /**< Objects created by CreateObject                             */
+    std::int64_t mLiveBytes;            /**< Bytes of the objects still alive                            */
+    std::int64_t mCreatedBytes;         /**< Bytes of all the created objects                            */
+    std::size_t  mRegistrationBytes;    /**< Bytes used by the injector for registering the factory      */
+};
+
+}   // namespace factory_injector
+
+#endif  // _FACTORY_INJECTOR_FACTORY_ACCOUNTING_HPP_
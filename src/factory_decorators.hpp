@@ -0,0 +1,290 @@
+/**
+ * @copyright Copyright (c) 2020 Emanuele Bellocchia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file  factory_decorators.hpp
+ * @brief Compile-time factory decorators and common decorator policies
+ *
+ */
+
+#ifndef _FACTORY_INJECTOR_FACTORY_DECORATORS_HPP_
+#define _FACTORY_INJECTOR_FACTORY_DECORATORS_HPP_
+
+/*
+ * Includes
+ */
+
+// Standard
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
+/*
+ * Namespaces
+ */
+namespace factory_injector
+{
+
+/* Internal namespace, shall not be used */
+namespace decorator_details
+{
+
+/**
+ * @brief  Decorated factory base class, specialized for the Create method signature
+ * @tparam TFactory   Factory type
+ * @tparam TSignature Create method signature (pointer to member function)
+ * @tparam TPolicies  Decorator policies
+ */
+template<class TFactory, class TSignature, class ... TPolicies>
+class DecoratedFactory;
+
+/**
+ * @brief  Decorated factory base class (specialization for constant Create methods).
+ *         It overrides the Create method as final, so the compiler can inline the policies and the decorated
+ *         Create method, that is called without virtual dispatch.
+ * @tparam TFactory   Factory type
+ * @tparam TObjectPtr Object pointer type
+ * @tparam TClass     Class declaring the Create method
+ * @tparam TParams    Create method parameter types
+ * @tparam TPolicies  Decorator policies
+ */
+template<class TFactory, class TObjectPtr, class TClass, class ... TParams, class ... TPolicies>
+class DecoratedFactory<TFactory, TObjectPtr (TClass::*)(TParams...) const, TPolicies...> : public TFactory,
+                                                                                         private TPolicies...
+{
+    /*
+     * Public methods
+     */
+    public:
+        // Inherit constructors of the decorated factory
+        using TFactory::TFactory;
+
+        /**
+         * @brief     Create an object by calling the decorated factory through the policies
+         * @param[in] params Parameters
+         * @return    Object pointer
+         */
+        TObjectPtr Create(TParams ... params) const final
+        {
+            return Invoke<TPolicies...>([&]() -> TObjectPtr
+                                        {
+                                            return TFactory::Create(std::forward<TParams>(params)...);
+                                        },
+                                        params...);
+        }
+
+        /**
+         * @brief  Get a policy, e.g. for reading its statistics
+         * @tparam TPolicy Policy type
+         * @return Constant reference to the policy
+         */
+        template<class TPolicy>
+        const TPolicy& GetPolicy(void) const
+        {
+            return *this;
+        }
+
+    /*
+     * Private methods
+     */
+    private:
+        /**
+         * @brief     Call the creator (end of the policies chain)
+         * @param[in] rcCreate Creator
+         * @param[in] rcArgs   Create arguments (unused)
+         * @tparam    TCreate  Creator type
+         * @tparam    TArgs    Create argument types
+         * @return    Object pointer
+         */
+        template<class TCreate, class ... TArgs>
+        TObjectPtr Invoke(const TCreate& rcCreate,
+                          const TArgs& ... rcArgs) const
+        {
+            static_cast<void>(sizeof...(rcArgs));
+            return rcCreate();
+        }
+
+        /**
+         * @brief     Call the creator through a policy and the following ones
+         * @param[in] rcCreate Creator
+         * @param[in] rcArgs   Create arguments, passed to the policies
+         * @tparam    TPolicy  Policy type
+         * @tparam    TOthers  Following policy types
+         * @tparam    TCreate  Creator type
+         * @tparam    TArgs    Create argument types
+         * @return    Object pointer
+         */
+        template<class TPolicy, class ... TOthers, class TCreate, class ... TArgs>
+        TObjectPtr Invoke(const TCreate& rcCreate,
+                          const TArgs& ... rcArgs) const
+        {
+            return static_cast<const TPolicy&>(*this).Around([&]() -> TObjectPtr
+                                                             {
+                                                                 return Invoke<TOthers...>(rcCreate, rcArgs...);
+                                                             },
+                                                             rcArgs...);
+        }
+};
+
+}   // namespace decorator_details
+
+/**
+ * @brief  Decorated factory.
+ *         It composes a concrete factory with a list of policies into a single concrete factory type, that can be
+ *         registered like the decorated one, e.g. OverwriteFactory<Decorated<MyRealObjFactory, Counted, Timed>>().
+ *         The first policy is the outermost one. Each policy shall define the following method, which shall call
+ *         rcCreate and return its result (it can also be stateful, using mutable members). The Create arguments are
+ *         passed as constant references, so policies can inspect them, while rcCreate forwards them to the factory:
+ *             template<class TCreate, class ... TArgs>
+ *             auto Around(const TCreate& rcCreate, const TArgs& ... rcArgs) const -> decltype(rcCreate());
+ *         The decorated factory shall have a single, constant Create method. Neither the factory nor its Create method
+ *         can be final, since the decorated factory derives from the factory and overrides Create (it doesn't compile).
+ * @tparam TFactory  Factory type
+ * @tparam TPolicies Decorator policies
+ */
+template<class TFactory, class ... TPolicies>
+using Decorated = decorator_details::DecoratedFactory<TFactory, decltype(&TFactory::Create), TPolicies...>;
+
+/**
+ * @brief Decorator policy that counts the created objects
+ */
+class Counted
+{
+    /*
+     * Public methods
+     */
+    public:
+        /**
+         * @brief     Create an object and count it
+         * @param[in] rcCreate Creator
+         * @param[in] rcArgs   Create arguments (unused)
+         * @tparam    TCreate  Creator type
+         * @tparam    TArgs    Create argument types
+         * @return    Object pointer
+         */
+        template<class TCreate, class ... TArgs>
+        auto Around(const TCreate& rcCreate,
+                    const TArgs& ... rcArgs) const -> decltype(rcCreate())
+        {
+            static_cast<void>(sizeof...(rcArgs));
+            mCount.fetch_add(1, std::memory_order_relaxed);
+            return rcCreate();
+        }
+
+        /**
+         * @brief  Get the number of Create calls
+         * @return Number of Create calls
+         */
+        std::uint64_t GetCount(void) const
+        {
+            return mCount.load(std::memory_order_relaxed);
+        }
+
+    /*
+     * Members
+     */
+    private:
+        mutable std::atomic<std::uint64_t> mCount{0};   /**< Number of Create calls */
+};
+
+/**
+ * @brief Decorator policy that measures the time spent creating objects
+ */
+class Timed
+{
+    /*
+     * Public methods
+     */
+    public:
+        /**
+         * @brief     Create an object and measure the time
+         * @param[in] rcCreate Creator
+         * @param[in] rcArgs   Create arguments (unused)
+         * @tparam    TCreate  Creator type
+         * @tparam    TArgs    Create argument types
+         * @return    Object pointer
+         */
+        template<class TCreate, class ... TArgs>
+        auto Around(const TCreate& rcCreate,
+                    const TArgs& ... rcArgs) const -> decltype(rcCreate())
+        {
+            static_cast<void>(sizeof...(rcArgs));
+            const auto start_time = std::chrono::steady_clock::now();
+            auto obj_ptr = rcCreate();
+            const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time);
+
+            mTotalNs.fetch_add(static_cast<std::uint64_t>(elapsed.count()), std::memory_order_relaxed);
+            return obj_ptr;
+        }
+
+        /**
+         * @brief  Get the total time spent in Create calls
+         * @return Total time
+         */
+        std::chrono::nanoseconds GetTotalTime(void) const
+        {
+            return std::chrono::nanoseconds(mTotalNs.load(std::memory_order_relaxed));
+        }
+
+    /*
+     * Members
+     */
+    private:
+        mutable std::atomic<std::uint64_t> mTotalNs{0};     /**< Total time in nanoseconds */
+};
+
+/**
+ * @brief Decorator policy that serializes the Create calls, for factories that are not thread-safe
+ */
+class Synchronized
+{
+    /*
+     * Public methods
+     */
+    public:
+        /**
+         * @brief     Create an object while holding the lock
+         * @param[in] rcCreate Creator
+         * @param[in] rcArgs   Create arguments (unused)
+         * @tparam    TCreate  Creator type
+         * @tparam    TArgs    Create argument types
+         * @return    Object pointer
+         */
+        template<class TCreate, class ... TArgs>
+        auto Around(const TCreate& rcCreate,
+                    const TArgs& ... rcArgs) const -> decltype(rcCreate())
+        {
+            static_cast<void>(sizeof...(rcArgs));
+            std::lock_guard<std::mutex> lock(mMutex);
+            return rcCreate();
+        }
+
+    /*
+     * Members
+     */
+    private:
+        mutable std::mutex mMutex;      /**< Create mutex */
+};
+
+}   // namespace factory_injector
+
+#endif  // _FACTORY_INJECTOR_FACTORY_DECORATORS_HPP_
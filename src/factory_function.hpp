@@ -0,0 +1,303 @@
+/**
+ * @copyright Copyright (c) 2020 Emanuele Bellocchia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file  factory_function.hpp
+ * @brief Declaration and definition of FactoryFunction class
+ *
+ */
+
+#ifndef _FACTORY_INJECTOR_FACTORY_FUNCTION_HPP_
+#define _FACTORY_INJECTOR_FACTORY_FUNCTION_HPP_
+
+/*
+ * Includes
+ */
+
+// Standard
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+// Project
+#include "factory_traits.hpp"
+#include "not_copyable_movable.hpp"
+
+/*
+ * Namespaces
+ */
+namespace factory_injector
+{
+
+/**
+ * @brief  Factory function class.
+ *         Factory that wraps a plain callable (lambda, function pointer or functor), without the need of writing an abstract
+ *         factory and a concrete one for each implementation. It's both the interface and the concrete factory, so it can be
+ *         registered, got and used like any other factory. The Create method is not virtual, but the callable is still called
+ *         indirectly through a function pointer, so the call cannot be inlined.
+ *         The tag identifies the factory, so that factory functions with the same signature but a different purpose are
+ *         registered separately (any type can be used, e.g. a declared-only struct).
+ *         Callables up to kBufferSize bytes are stored in an internal buffer, so no memory is allocated, bigger ones are
+ *         allocated on the heap. The callable shall be const-callable with TParams and return a pointer convertible to
+ *         tObjectPtr (e.g. the result of std::make_unique).
+ * @tparam TTag    Tag type, it identifies the factory
+ * @tparam TObject Object type
+ * @tparam TParams Parameter types of the Create method
+ */
+template<class TTag, class TObject, class ... TParams>
+class FactoryFunction final : public FactoryTraits<FactoryFunction<TTag, TObject, TParams...>, TObject>,
+                              public NotCopyMovable
+{
+    /*
+     * Types
+     */
+    public:
+        /** Object pointer type definition */
+        using tObjectPtr = typename FactoryTraits<FactoryFunction<TTag, TObject, TParams...>, TObject>::tObjectPtr;
+
+    private:
+        /** Invoker function type definition */
+        using tInvoker   = tObjectPtr (*)(const void *, TParams...);
+        /** Destroyer function type definition */
+        using tDestroyer = void (*)(void *);
+
+    /*
+     * Constants
+     */
+    public:
+        /** Size of the internal buffer for the callable, bigger callables are allocated on the heap */
+        static constexpr std::size_t kBufferSize = 4 * sizeof(void *);
+
+    /*
+     * Public methods
+     */
+    public:
+        /**
+         * @brief     Constructor
+         * @param[in] rrCallable Callable
+         * @tparam    TCallable  Callable type
+         */
+        template<class TCallable>
+        explicit FactoryFunction(TCallable&& rrCallable)
+        {
+            // Helper type for shortening
+            using tCallable = std::decay_t<TCallable>;
+            using tInline   = std::integral_constant<bool, sizeof(tCallable) <= kBufferSize>;
+
+            static_assert(alignof(tCallable) <= alignof(std::max_align_t), "The callable alignment is not supported");
+
+            Construct<tCallable>(tInline(), std::forward<TCallable>(rrCallable));
+        }
+
+        /**
+         * @brief Destructor
+         */
+        ~FactoryFunction(void)
+        {
+            mpDestroyer(mBuffer);
+        }
+
+        /**
+         * @brief     Create an object by calling the callable
+         * @param[in] params Parameters
+         * @return    Object pointer
+         */
+        tObjectPtr Create(TParams ... params) const
+        {
+            return mpInvoker(mBuffer, std::forward<TParams>(params)...);
+        }
+
+    /*
+     * Private methods
+     */
+    private:
+        /**
+         * @brief     Construct the callable in the internal buffer
+         * @param[in] rrCallable Callable
+         * @tparam    TStored    Stored callable type
+         * @tparam    TCallable  Callable type
+         * @return    void
+         */
+        template<class TStored, class TCallable>
+        void Construct(std::true_type,
+                       TCallable&& rrCallable)
+        {
+            ::new (static_cast<void *>(mBuffer)) TStored(std::forward<TCallable>(rrCallable));
+
+            mpInvoker = [](const void *pCallable, TParams ... params) -> tObjectPtr
+            {
+                return (*static_cast<const TStored *>(pCallable))(std::forward<TParams>(params)...);
+            };
+            mpDestroyer = [](void *pCallable)
+            {
+                static_cast<TStored *>(pCallable)->~TStored();
+            };
+        }
+
+        /**
+         * @brief     Construct the callable on the heap, its pointer is stored in the internal buffer
+         * @param[in] rrCallable Callable
+         * @tparam    TStored    Stored callable type
+         * @tparam    TCallable  Callable type
+         * @return    void
+         */
+        template<class TStored, class TCallable>
+        void Construct(std::false_type,
+                       TCallable&& rrCallable)
+        {
+            ::new (static_cast<void *>(mBuffer)) TStored *(new TStored(std::forward<TCallable>(rrCallable)));
+
+            mpInvoker = [](const void *pCallable, TParams ... params) -> tObjectPtr
+            {
+                return (**static_cast<const TStored * const *>(pCallable))(std::forward<TParams>(params)...);
+            };
+            mpDestroyer = [](void *pCallable)
+            {
+                delete *static_cast<TStored **>(pCallable);
+            };
+        }
+
+    /*
+     * Members
+     */
+    private:
+        alignas(std::max_align_t) unsigned char mBuffer[kBufferSize];   /**< Callable buffer   */
+        tInvoker                                mpInvoker;              /**< Invoker function  */
+        tDestroyer                              mpDestroyer;            /**< Destroyer function */
+};
+
+/* Internal namespace, shall not be used */
+namespace function_details
+{
+
+/**
+ * @brief  Interface function class (declaration only, the Create member pointer type is decomposed by the specialization)
+ * @tparam TInterface Factory interface type
+ * @tparam TCallable  Callable type
+ * @tparam TCreate    Type of the pointer to the Create method of the interface
+ */
+template<class TInterface, class TCallable, class TCreate>
+class InterfaceFunction;
+
+/**
+ * @brief  Interface function class.
+ *         Concrete factory that implements the Create method of an existing factory interface by calling a callable,
+ *         so a callable can be registered for an interface without writing a concrete factory.
+ *         The interface shall have a single const Create method.
+ * @tparam TInterface Factory interface type
+ * @tparam TCallable  Callable type
+ * @tparam TObjectPtr Object pointer type
+ * @tparam TBase      Class declaring the Create method
+ * @tparam TParams    Parameter types of the Create method
+ */
+template<class TInterface, class TCallable, class TObjectPtr, class TBase, class ... TParams>
+class InterfaceFunction<TInterface, TCallable, TObjectPtr (TBase::*)(TParams...) const> final : public TInterface
+{
+    /*
+     * Public methods
+     */
+    public:
+        /**
+         * @brief     Constructor
+         * @param[in] rrCallable Callable
+         * @tparam    TArg       Callable argument type
+         */
+        template<class TArg>
+        explicit InterfaceFunction(TArg&& rrCallable) :
+            mCallable(std::forward<TArg>(rrCallable))
+        {}
+
+        /**
+         * @brief     Create an object by calling the callable
+         * @param[in] params Parameters
+         * @return    Object pointer
+         */
+        TObjectPtr Create(TParams ... params) const override
+        {
+            return mCallable(std::forward<TParams>(params)...);
+        }
+
+    /*
+     * Members
+     */
+    private:
+        TCallable mCallable;    /**< Callable */
+};
+
+}   // namespace function_details
+
+/* Internal namespace, shall not be used */
+namespace traits_details
+{
+
+/**
+ * @brief  Helper struct for checking if a type is a factory function
+ * @tparam T Class type
+ */
+template<class T>
+struct is_factory_function : std::false_type
+{};
+
+/**
+ * @brief  Helper struct for checking if a type is a factory function (specialization for factory functions)
+ * @tparam TTag    Tag type
+ * @tparam TObject Object type
+ * @tparam TParams Parameter types
+ */
+template<class TTag, class TObject, class ... TParams>
+struct is_factory_function<FactoryFunction<TTag, TObject, TParams...>> : std::true_type
+{};
+
+/**
+ * @brief  Helper struct for getting the factory registered for a callable: the factory function itself,
+ *         or an interface function for factory interfaces
+ * @tparam TFunction Factory function or factory interface type
+ * @tparam TCallable Callable type
+ */
+template<class TFunction, class TCallable, bool = is_factory_function<TFunction>::value>
+struct function_factory
+{
+    using type = TFunction;
+};
+
+/**
+ * @brief  Helper struct for getting the factory registered for a callable (specialization for factory interfaces)
+ * @tparam TFunction Factory interface type
+ * @tparam TCallable Callable type
+ */
+template<class TFunction, class TCallable>
+struct function_factory<TFunction, TCallable, false>
+{
+    using type = function_details::InterfaceFunction<TFunction, std::decay_t<TCallable>, decltype(&TFunction::Create)>;
+};
+
+/**
+ * @brief  Helper alias for getting the factory registered for a callable
+ * @tparam TFunction Factory function or factory interface type
+ * @tparam TCallable Callable type
+ */
+template<class TFunction, class TCallable>
+using function_factory_t = typename function_factory<TFunction, TCallable>::type;
+
+}   // namespace traits_details
+
+}   // namespace factory_injector
+
+#endif  // _FACTORY_INJECTOR_FACTORY_FUNCTION_HPP_
@@ -32,13 +32,34 @@
  */
 
 // Standard
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <exception>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
 #include <unordered_map>
 #include <typeindex>
+#include <utility>
+#include <vector>
 // Project
+#include "factory_function.hpp"
+#include "factory_probes.hpp"
 #include "factory_traits.hpp"
 #include "not_copyable_movable.hpp"
+#include "object_generator.hpp"
+#include "persistent_map.hpp"
+#include "shared_object_cache.hpp"
+#include "static_registration.hpp"
+#include "thread_executor.hpp"
+#if defined(FACTORY_INJECTOR_ENABLE_TRACE)
+#include "trace_recorder.hpp"
+#endif
 
 /*
  * Namespaces
@@ -70,6 +91,14 @@ class AnyInstance
          * @return Instance pointer
          */
         virtual void *GetPtr(void) = 0;
+
+#if defined(FACTORY_INJECTOR_ENABLE_ACCOUNTING)
+        /**
+         * @brief  Get the memory used by the container and its instances
+         * @return Size in bytes
+         */
+        virtual std::size_t GetSize(void) const = 0;
+#endif
 };
 
 /**
@@ -110,6 +139,17 @@ class RealInstance final : public AnyInstance
             return mInstancePtr.get();
         }
 
+#if defined(FACTORY_INJECTOR_ENABLE_ACCOUNTING)
+        /**
+         * @brief  Get the memory used by the container and its instance
+         * @return Size in bytes
+         */
+        std::size_t GetSize(void) const override
+        {
+            return sizeof(*this) + sizeof(TInstance);
+        }
+#endif
+
     /*
      * Members
      */
@@ -129,6 +169,304 @@ std::unique_ptr<AnyInstance> MakeUniqueAnyInstance(TArgs&& ... rrArgs)
     return std::make_unique<RealInstance<TInstance>>(std::forward<TArgs>(rrArgs)...);
 }
 
+/** Cache line size, used for keeping per-thread data separated */
+constexpr std::size_t kCacheLineSize = 64;
+
+/**
+ * @brief  Get a new instance identifier, unique for the whole process lifetime
+ * @return Instance identifier
+ */
+inline std::uint64_t NextInstanceId(void)
+{
+    static std::atomic<std::uint64_t> next_id(0);
+
+    return ++next_id;
+}
+
+/**
+ * @brief Owner of per-thread replicas, notified when a thread that used them exits
+ */
+class ReplicaOwner
+{
+    public:
+        /**
+         * @brief Destructor
+         */
+        virtual ~ReplicaOwner(void) = default;
+
+        /**
+         * @brief     Release the replica of a thread
+         * @param[in] cThreadId Thread identifier
+         * @return    void
+         */
+        virtual void ReleaseThread(const std::thread::id cThreadId) = 0;
+};
+
+/**
+ * @brief Thread exit hooks class.
+ *        It keeps the owners of the replicas used by the current thread and, when the thread exits, it releases
+ *        the replicas that are still alive. Owners are kept by weak pointer, so they can be destroyed before.
+ */
+class ThreadExitHooks final
+{
+    public:
+        /**
+         * @brief Destructor, it's called when the thread exits
+         */
+        ~ThreadExitHooks(void)
+        {
+            const auto cThreadId = std::this_thread::get_id();
+            for (const auto& owner_wptr : mOwners)
+            {
+                auto owner_ptr = owner_wptr.lock();
+                if (owner_ptr)
+                {
+                    owner_ptr->ReleaseThread(cThreadId);
+                }
+            }
+        }
+
+        /**
+         * @brief     Add the owner of a replica used by the current thread
+         * @param[in] ownerWptr Owner weak pointer
+         * @return    void
+         */
+        void Add(std::weak_ptr<ReplicaOwner> ownerWptr)
+        {
+            // Drop the owners already destroyed, so that hooks don't grow with the number of containers
+            mOwners.erase(std::remove_if(mOwners.begin(), mOwners.end(),
+                                         [](const std::weak_ptr<ReplicaOwner>& rcOwnerWptr) { return rcOwnerWptr.expired(); }),
+                          mOwners.end());
+            mOwners.push_back(std::move(ownerWptr));
+        }
+
+        /**
+         * @brief  Get the hooks of the current thread
+         * @return Thread exit hooks reference
+         */
+        static ThreadExitHooks& Get(void)
+        {
+            thread_local ThreadExitHooks hooks;
+
+            return hooks;
+        }
+
+    private:
+        std::vector<std::weak_ptr<ReplicaOwner>> mOwners;   /**< Replica owners */
+};
+
+/**
+ * @brief  Per-thread instance class.
+ *         Container for a class instance that is replicated for each thread using it.
+ *         Replicas are constructed lazily by the thread that first uses them, so with the default first-touch
+ *         memory policy they are placed on the NUMA node local to that thread. Each replica is aligned to
+ *         a cache line, so replicas of different threads never share one.
+ *         Replicas are destroyed when their thread exits (on that thread), or together with the container, so
+ *         a new thread never gets the replica of an exited one, even if it has the same identifier.
+ * @tparam TInstance Instance type
+ */
+template<class TInstance>
+class PerThreadInstance final : public AnyInstance
+{
+    /*
+     * Types
+     */
+    private:
+        /**
+         * @brief Instance replica, aligned to a cache line
+         */
+        struct alignas(kCacheLineSize) Replica
+        {
+            /**
+             * @brief     Constructor
+             * @param[in] rrArgs Argument lists for constructing class
+             * @tparam    TArgs Variadic parameter types
+             */
+            template<class ... TArgs>
+            Replica(TArgs&& ... rrArgs) :
+                mInstance(std::forward<TArgs>(rrArgs)...)
+            {}
+
+            TInstance mInstance;    /**< Instance */
+        };
+
+        /** Replica pointer type definition */
+        using tReplicaPtr  = std::unique_ptr<Replica>;
+        /** Replica creator type definition */
+        using tCreator     = std::function<tReplicaPtr(void)>;
+        /** Replica container type definition */
+        using tReplicaCont = std::unordered_map<std::thread::id, tReplicaPtr>;
+
+        /**
+         * @brief Replicas of all the threads, shared with the exit hooks of the threads using them
+         */
+        struct Replicas final : public ReplicaOwner
+        {
+            /**
+             * @brief     Release the replica of a thread, it's destroyed outside the lock
+             * @param[in] cThreadId Thread identifier
+             * @return    void
+             */
+            void ReleaseThread(const std::thread::id cThreadId) override
+            {
+                tReplicaPtr replica_ptr;
+                {
+                    std::lock_guard<std::mutex> lock(mMutex);
+
+                    auto replica_itr = mReplicaCont.find(cThreadId);
+                    if (replica_itr != mReplicaCont.end())
+                    {
+                        replica_ptr = std::move(replica_itr->second);
+                        mReplicaCont.erase(replica_itr);
+                    }
+                }
+            }
+
+            mutable std::mutex mMutex;          /**< Replicas mutex     */
+            tReplicaCont       mReplicaCont;    /**< Replicas container */
+        };
+        /** Thread cache type definition, it associates instance identifiers to the replica of the current thread */
+        using tThreadCache = std::vector<std::pair<std::uint64_t, TInstance *>>;
+
+    /*
+     * Constants
+     */
+    private:
+        /** Maximum number of entries of the thread cache */
+        static constexpr std::size_t kThreadCacheSize = 8;
+
+    /*
+     * Public methods
+     */
+    public:
+        /**
+         * @brief     Constructor
+         * @param[in] rrArgs Argument lists for constructing class, they are copied and used for each replica
+         * @tparam    TArgs Variadic parameter types
+         */
+        template<class ... TArgs>
+        PerThreadInstance(TArgs&& ... rrArgs) :
+            mId(NextInstanceId()),
+            mCreator(MakeCreator(std::make_tuple(std::forward<TArgs>(rrArgs)...),
+                                 std::index_sequence_for<TArgs...>())),
+            mReplicasPtr(std::make_shared<Replicas>())
+        {}
+
+        /**
+         * @brief  Get instance pointer of the current thread
+         * @return Instance pointer
+         */
+        void *GetPtr(void) override
+        {
+            // Fast path: look in the thread cache, without locking
+            auto& thread_cache = GetThreadCache();
+            for (auto cache_itr = thread_cache.rbegin(); cache_itr != thread_cache.rend(); ++cache_itr)
+            {
+                if (cache_itr->first == mId)
+                {
+                    return cache_itr->second;
+                }
+            }
+
+            // Slow path: get or construct the replica of the current thread
+            TInstance *p_instance;
+            bool is_new_replica = false;
+            {
+                std::lock_guard<std::mutex> lock(mReplicasPtr->mMutex);
+
+                auto& replica_ptr = mReplicasPtr->mReplicaCont[std::this_thread::get_id()];
+                if (!replica_ptr)
+                {
+                    replica_ptr    = mCreator();
+                    is_new_replica = true;
+                }
+                p_instance = &replica_ptr->mInstance;
+            }
+            // Release the replica when the thread exits
+            if (is_new_replica)
+            {
+                ThreadExitHooks::Get().Add(mReplicasPtr);
+            }
+            // The cache is bounded, evicted entries are found again in the replicas container
+            if (thread_cache.size() == kThreadCacheSize)
+            {
+                thread_cache.erase(thread_cache.begin());
+            }
+            thread_cache.emplace_back(mId, p_instance);
+
+            return p_instance;
+        }
+
+#if defined(FACTORY_INJECTOR_ENABLE_ACCOUNTING)
+        /**
+         * @brief  Get the memory used by the container and its replicas
+         * @return Size in bytes
+         */
+        std::size_t GetSize(void) const override
+        {
+            std::lock_guard<std::mutex> lock(mReplicasPtr->mMutex);
+
+            return sizeof(*this) + sizeof(Replicas) + (mReplicasPtr->mReplicaCont.size() * (sizeof(typename tReplicaCont::value_type) + sizeof(Replica)));
+        }
+#endif
+
+    /*
+     * Private methods
+     */
+    private:
+        /**
+         * @brief     Make the replica creator from the constructor arguments
+         * @param[in] args Tuple of constructor arguments
+         * @tparam    TTuple   Tuple type
+         * @tparam    TIndexes Tuple indexes
+         * @return    Replica creator
+         */
+        template<class TTuple, std::size_t ... TIndexes>
+        static tCreator MakeCreator(TTuple args,
+                                    std::index_sequence<TIndexes...>)
+        {
+            return [args]() { return std::make_unique<Replica>(std::get<TIndexes>(args)...); };
+        }
+
+        /**
+         * @brief  Get the cache of the current thread.
+         *         Entries of destroyed containers are never matched again, since identifiers are not reused,
+         *         and they are eventually evicted.
+         * @return Thread cache reference
+         */
+        static tThreadCache& GetThreadCache(void)
+        {
+            thread_local tThreadCache thread_cache;
+
+            return thread_cache;
+        }
+
+    /*
+     * Members
+     */
+    private:
+        const std::uint64_t       mId;            /**< Instance identifier */
+        tCreator                  mCreator;       /**< Replica creator     */
+        std::shared_ptr<Replicas> mReplicasPtr;   /**< Replicas            */
+};
+
+/**
+ * @brief Entry of the instance container.
+ *        The owner keeps alive the code the instance depends on (e.g. the plugin library that defines it),
+ *        while the dependencies keep alive the auto-wired factories referenced by the instance.
+ *        They are declared before the instance, so that they're released only after the instance is destroyed.
+ */
+struct InstanceEntry
+{
+    std::shared_ptr<void>                             mOwnerPtr;      /**< Instance owner, empty if not needed */
+    std::vector<std::shared_ptr<const InstanceEntry>> mDependencies;  /**< Auto-wired dependencies             */
+    std::unique_ptr<AnyInstance>                      mInstancePtr;   /**< Instance pointer                    */
+    mutable SharedObjectCache    mSharedCache;  /**< Cache of shared objects             */
+#if defined(FACTORY_INJECTOR_ENABLE_ACCOUNTING)
+    accounting_details::InterfaceCounters *mpCounters = nullptr;  /**< Interface counters */
+#endif
+};
+
 }   // namespace injector_details
 
 /**
@@ -167,22 +505,177 @@ class FactoryNotRegisteredEx : public std::runtime_error
         {}
 };
 
+/* Internal namespace, shall not be used */
+namespace injector_details
+{
+
+/** Maximum number of constructor parameters for auto-wiring */
+constexpr std::size_t kMaxAutoWireParams = 8;
+
+/**
+ * @brief Auto-wiring argument.
+ *        It's passed for each constructor parameter of a factory that is not default-constructible, and it's converted
+ *        to any constant reference to a factory interface by resolving it, so that the factory can keep the reference.
+ *        The resolved entries are collected, so that they're kept alive together with the factory.
+ */
+class AutoWireArg
+{
+    /*
+     * Types
+     */
+    public:
+        /** Entry container type definition */
+        using tEntryCont    = persistent_details::PersistentMap<std::type_index, InstanceEntry>;
+        /** Dependencies type definition */
+        using tDependencies = std::vector<std::shared_ptr<const InstanceEntry>>;
+
+    /*
+     * Public methods
+     */
+    public:
+        /**
+         * @brief     Constructor
+         * @param[in] rcEntryCont   Entry container
+         * @param[in] rDependencies Dependencies, resolved entries are added to it
+         */
+        AutoWireArg(const tEntryCont& rcEntryCont,
+                    tDependencies& rDependencies) :
+            mrcEntryCont(rcEntryCont),
+            mrDependencies(rDependencies)
+        {}
+
+        /**
+         * @brief  Resolve a factory interface.
+         *         FactoryNotRegisteredEx is thrown if the factory is not existent.
+         * @tparam TInterface Factory interface type
+         * @return Constant reference to factory interface
+         */
+        template<class TInterface,
+                 std::enable_if_t<traits_details::is_factory_interface<TInterface>::value, int> = 0>
+        operator const TInterface&(void) const
+        {
+            const auto* p_entry_ptr = mrcEntryCont.FindPtr(std::type_index(typeid(TInterface)));
+            if (p_entry_ptr == nullptr)
+            {
+                throw FactoryNotRegisteredEx(typeid(TInterface).name());
+            }
+
+            mrDependencies.push_back(*p_entry_ptr);
+            return *static_cast<TInterface *>((*p_entry_ptr)->mInstancePtr->GetPtr());
+        }
+
+    /*
+     * Members
+     */
+    private:
+        const tEntryCont& mrcEntryCont;     /**< Entry container */
+        tDependencies&    mrDependencies;   /**< Dependencies    */
+};
+
+/**
+ * @brief  Helper struct for checking if a type is constructible from a number of arguments of the same type
+ * @tparam T        Class type
+ * @tparam TArg     Argument type
+ * @tparam TIndexes Argument indexes
+ */
+template<class T, class TArg, class TIndexes>
+struct is_constructible_n;
+
+/**
+ * @brief  Helper struct for checking if a type is constructible from a number of arguments of the same type (specialization)
+ * @tparam T        Class type
+ * @tparam TArg     Argument type
+ * @tparam TIndexes Argument indexes
+ */
+template<class T, class TArg, std::size_t ... TIndexes>
+struct is_constructible_n<T, TArg, std::index_sequence<TIndexes...>>
+    : std::is_constructible<T, std::conditional_t<true, TArg, std::integral_constant<std::size_t, TIndexes>>...>
+{};
+
+/**
+ * @brief  Helper struct for getting the minimum number (starting from TCount) of auto-wiring arguments a factory
+ *         is constructible from, 0 if none
+ * @tparam TFactory Factory type
+ * @tparam TCount   Number of arguments
+ */
+template<class TFactory, std::size_t TCount = 1>
+struct auto_wire_arity
+    : std::conditional_t<is_constructible_n<TFactory, const AutoWireArg&, std::make_index_sequence<TCount>>::value,
+                         std::integral_constant<std::size_t, TCount>,
+                         auto_wire_arity<TFactory, TCount + 1>>
+{};
+
+/**
+ * @brief  Helper struct for getting the number of auto-wiring arguments (specialization for the end of the search)
+ * @tparam TFactory Factory type
+ */
+template<class TFactory>
+struct auto_wire_arity<TFactory, kMaxAutoWireParams + 1> : std::integral_constant<std::size_t, 0>
+{};
+
+}   // namespace injector_details
+
 /**
  * @brief Factory injector class.
  *        It allows the registering and getting for factory instances, allowing ruin-time injection of fake or mock factories.
  */
 class FactoryInjector final : public NotCopyMovable
 {
+    /*
+     * Friend classes
+     */
+    friend class PluginRegistrar;
+
     /*
      * Types
      */
     private:
+        /** Owner pointer type definition */
+        using tOwnerPtr        = std::shared_ptr<void>;
         /** Any instance pointer type definition */
         using tAnyInstancePtr  = std::unique_ptr<injector_details::AnyInstance>;
-        /** Instance container type definition */
-        using tInstanceCont    = std::unordered_map<std::type_index, tAnyInstancePtr>;
-        /** Instance container constant iterator type definition */
-        using tInstanceContItr = tInstanceCont::const_iterator;
+        /** Instance container type definition, entries are shared with forked injectors */
+        using tInstanceCont    = persistent_details::PersistentMap<std::type_index, injector_details::InstanceEntry>;
+
+    /*
+     * Classes
+     */
+    private:
+        /**
+         * @brief  Object creator of the generators, so that generated objects are created like by CreateObject
+         *         (i.e. with probes, accounting and tracing)
+         * @tparam TFactory Factory type
+         */
+        template<class TFactory>
+        class GeneratorCreator
+        {
+            public:
+                /**
+                 * @brief     Constructor
+                 * @param[in] rcFactoryInjector Factory injector reference
+                 */
+                explicit GeneratorCreator(const FactoryInjector& rcFactoryInjector) :
+                    mrcFactoryInjector(rcFactoryInjector)
+                {}
+
+                /**
+                 * @brief     Create an object
+                 * @param[in] rcFactory Factory reference
+                 * @param[in] rrArgs    Argument or tuple of arguments
+                 * @tparam    TArgs     Argument or tuple type
+                 * @return    Object pointer
+                 */
+                template<class TArgs>
+                auto operator()(const traits_details::get_interface_t<TFactory>& rcFactory,
+                                TArgs&& rrArgs) const
+                    -> typename traits_details::get_factory_t<TFactory>::tObjectPtr
+                {
+                    return mrcFactoryInjector.CreateFromFactoryArgs<TFactory>(rcFactory, std::forward<TArgs>(rrArgs));
+                }
+
+            private:
+                const FactoryInjector& mrcFactoryInjector;  /**< Factory injector reference */
+        };
 
     /**
      * Public methods
@@ -207,14 +700,7 @@ class FactoryInjector final : public NotCopyMovable
         template<class TFactory, class ... TArgs>
         void OverwriteFactory(TArgs&& ... rrArgs)
         {
-            // Get interface type index
-            auto type_idx = GetInterfaceTypeIndex<TFactory>();
-
-            // Helper type for shortening
-            using tFactory = typename traits_details::get_factory<TFactory>::type;
-
-            // Register or overwrite instance
-            mInstanceCont[type_idx] = injector_details::MakeUniqueAnyInstance<tFactory>(std::forward<TArgs>(rrArgs)...);
+            EmplaceFactory<TFactory>(nullptr, std::forward<TArgs>(rrArgs)...);
         }
 
         /**
@@ -227,18 +713,89 @@ class FactoryInjector final : public NotCopyMovable
         template<class TFactory, class ... TArgs>
         void RegisterFactory(TArgs&& ... rrArgs)
         {
-            // Find factory
-            auto instance_itr = FindFactory<TFactory>();
+            ThrowIfRegistered<TFactory>();
+            OverwriteFactory<TFactory>(std::forward<TArgs>(rrArgs)...);
+        }
 
-            // Register if not found
-            if (instance_itr == std::cend(mInstanceCont))
-            {
-                OverwriteFactory<TFactory>(std::forward<TArgs>(rrArgs)...);
-            }
-            else
-            {
-                throw FactoryAlreadyRegisteredEx(typeid(TFactory).name());
-            }
+        /**
+         * @brief     Register a factory function by overwriting it. A factory function wraps a plain callable, so there's
+         *            no need to write an abstract factory and a concrete one for each implementation, e.g.:
+         *                using tObjFactory = FactoryFunction<struct ObjFactoryTag, IObj, int>;
+         *                fi.OverwriteFactoryFunction<tObjFactory>([](int value) { return std::make_unique<Obj>(value); });
+         *                auto obj = fi.CreateObject<tObjFactory>(10);
+         *            Small callables are stored without allocating memory and the Create method is not virtual (the callable
+         *            is still called indirectly, through a function pointer).
+         *            The type can also be an existing factory interface with a single const Create method, in this case the callable
+         *            implements the Create method of the interface (through a virtual call, like any other concrete factory), e.g.:
+         *                fi.OverwriteFactoryFunction<IObjFactory>([](int value) { return std::make_unique<Obj>(value); });
+         * @param[in] rrCallable Callable, see FactoryFunction
+         * @tparam    TFunction  Factory function or factory interface type
+         * @tparam    TCallable  Callable type
+         * @return    void
+         */
+        template<class TFunction, class TCallable>
+        void OverwriteFactoryFunction(TCallable&& rrCallable)
+        {
+            static_assert(traits_details::is_factory_function<traits_details::get_factory_t<TFunction>>::value ||
+                          traits_details::is_factory_interface<traits_details::get_factory_t<TFunction>>::value,
+                          "The factory type shall be a FactoryFunction or a factory interface");
+
+            OverwriteFactory<traits_details::function_factory_t<traits_details::get_factory_t<TFunction>, TCallable>>(std::forward<TCallable>(rrCallable));
+        }
+
+        /**
+         * @brief     Same of OverwriteFactoryFunction method but, if the factory is already existent, a FactoryAlreadyRegisteredEx exception is thrown.
+         * @param[in] rrCallable Callable, see FactoryFunction
+         * @tparam    TFunction  Factory function or factory interface type
+         * @tparam    TCallable  Callable type
+         * @return    void
+         */
+        template<class TFunction, class TCallable>
+        void RegisterFactoryFunction(TCallable&& rrCallable)
+        {
+            ThrowIfRegistered<TFunction>();
+            OverwriteFactoryFunction<TFunction>(std::forward<TCallable>(rrCallable));
+        }
+
+        /**
+         * @brief     Register a per-thread factory by overwriting it. The factory type is represented by the template parameter.
+         *            Instead of a single factory shared by all threads, each thread calling GetFactory gets its own factory,
+         *            constructed lazily from a copy of the specified arguments. This is useful for factories with internal state
+         *            (e.g. counters, caches or random generators), which is not shared between threads anymore.
+         *            Each factory is aligned to a cache line and constructed by the thread using it.
+         * @param[in] rrArgs   Argument lists for constructing factories, copied for each thread
+         * @tparam    TFactory Factory type
+         * @tparam    TArgs    Variadic parameter types
+         * @return    void
+         */
+        template<class TFactory, class ... TArgs>
+        void OverwriteFactoryPerThread(TArgs&& ... rrArgs)
+        {
+            // Helper type for shortening
+            using tFactory = traits_details::get_factory_t<TFactory>;
+
+#if defined(FACTORY_INJECTOR_ENABLE_TRACE)
+            const std::uint64_t start_ns = GetTraceTime();
+#endif
+            EmplaceInstance<TFactory>(nullptr,
+                                      std::make_unique<injector_details::PerThreadInstance<tFactory>>(std::forward<TArgs>(rrArgs)...));
+#if defined(FACTORY_INJECTOR_ENABLE_TRACE)
+            RecordTraceEvent<TFactory>(TraceEventType::OverwriteFactory, start_ns);
+#endif
+        }
+
+        /**
+         * @brief     Same of OverwriteFactoryPerThread method but, if the factory is already existent, a FactoryAlreadyRegisteredEx exception is thrown.
+         * @param[in] rrArgs   Argument lists for constructing factories, copied for each thread
+         * @tparam    TFactory Factory type
+         * @tparam    TArgs    Variadic parameter types
+         * @return    void
+         */
+        template<class TFactory, class ... TArgs>
+        void RegisterFactoryPerThread(TArgs&& ... rrArgs)
+        {
+            ThrowIfRegistered<TFactory>();
+            OverwriteFactoryPerThread<TFactory>(std::forward<TArgs>(rrArgs)...);
         }
 
         /**
@@ -249,22 +806,17 @@ class FactoryInjector final : public NotCopyMovable
          */
         template<class TFactory>
         auto GetFactory(void) const
-            -> typename traits_details::get_interface_const_ref<TFactory>::type
+            -> traits_details::get_interface_const_ref_t<TFactory>
         {
-            // Find factory
-            auto instance_itr = FindFactory<TFactory>();
+#if defined(FACTORY_INJECTOR_ENABLE_TRACE)
+            const std::uint64_t start_ns = GetTraceTime();
+            auto& factory = ResolveFactory<TFactory>();
+            RecordTraceEvent<TFactory>(TraceEventType::GetFactory, start_ns);
 
-            // Return it if found
-            if (instance_itr != std::cend(mInstanceCont))
-            {
-                using tInterface = typename traits_details::get_interface<TFactory>::type;
-
-                return *static_cast<tInterface *>(instance_itr->second->GetPtr());
-            }
-            else
-            {
-                throw FactoryNotRegisteredEx(typeid(TFactory).name());
-            }
+            return factory;
+#else
+            return ResolveFactory<TFactory>();
+#endif
         }
 
         /**
@@ -281,30 +833,564 @@ class FactoryInjector final : public NotCopyMovable
          */
         template<class TFactory, class ... TArgs>
         auto CreateObject(TArgs&& ... rrArgs) const
-            -> typename traits_details::get_factory<TFactory>::type::tObjectPtr
+            -> typename traits_details::get_factory_t<TFactory>::tObjectPtr
+        {
+            auto& factory = ResolveFactory<TFactory>();
+
+            return CreateFromFactory<TFactory>(factory, std::forward<TArgs>(rrArgs)...);
+        }
+
+        /**
+         * @brief     Create many objects from a factory in parallel. The work is split in contiguous slices of indexes,
+         *            one for each executor thread, and each thread writes its objects directly into its slice of the result,
+         *            so results are in index order and threads don't share any container or lock. Objects are allocated by
+         *            the factory on the creating thread, so the per-thread arenas of the allocator are used.
+         *            Each thread resolves the factory once, so per-thread factories are supported. Otherwise, the factory
+         *            Create method shall be thread-safe.
+         *            If the creation throws, the first exception is rethrown and no object is returned.
+         * @param[in] cCount        Number of objects
+         * @param[in] rcArgsGen     Arguments generator, called with the object index. It shall return the argument for the factory
+         *                          Create method or a std::tuple of arguments, and it shall be thread-safe.
+         * @param[in] rcExecutor    Executor, see ThreadExecutor
+         * @tparam    TFactory      Factory type
+         * @tparam    TArgsGen      Arguments generator type
+         * @tparam    TExecutor     Executor type
+         * @return    Vector of object pointers
+         */
+        template<class TFactory, class TArgsGen, class TExecutor = ThreadExecutor>
+        auto CreateObjectsParallel(const std::size_t cCount,
+                                   const TArgsGen& rcArgsGen,
+                                   const TExecutor& rcExecutor = TExecutor()) const
+            -> std::vector<typename traits_details::get_factory_t<TFactory>::tObjectPtr>
+        {
+            std::vector<typename traits_details::get_factory_t<TFactory>::tObjectPtr> objects(cCount);
+
+            // Split work in contiguous slices
+            const std::size_t cSliceCount = std::max<std::size_t>(1, std::min(rcExecutor.GetThreadCount(), cCount));
+            const std::size_t cSliceSize  = cCount / cSliceCount;
+            const std::size_t cRemainder  = cCount % cSliceCount;
+
+            rcExecutor(cSliceCount, [&](const std::size_t cSliceIdx)
+            {
+                // The first slices take one more object if not evenly divisible
+                std::size_t begin_idx = (cSliceIdx * cSliceSize) + std::min(cSliceIdx, cRemainder);
+                std::size_t end_idx   = begin_idx + cSliceSize + ((cSliceIdx < cRemainder) ? 1 : 0);
+
+                auto& factory = GetFactory<TFactory>();
+                for (std::size_t obj_idx = begin_idx; obj_idx < end_idx; obj_idx++)
+                {
+                    objects[obj_idx] = CreateFromFactoryArgs<TFactory>(factory, rcArgsGen(obj_idx));
+                }
+            });
+
+            return objects;
+        }
+
+        /**
+         * @brief     Get a shared, immutable object created by a factory with the specified arguments, creating it only
+         *            if no object was already created with equal arguments. Objects are cached for each factory interface
+         *            and the cache is cleared when the factory is overwritten. Arguments are decayed (C strings are
+         *            stored as std::string, so they're compared by content), they shall be hashable by std::hash
+         *            and equality comparable.
+         *            Without arguments, the object is a lazily created and thread-safe singleton for the factory interface.
+         *            The cache is thread-safe: lookups run concurrently and the object is created outside the cache lock,
+         *            while other threads requesting the same object wait for it. So the factory Create method can get
+         *            other shared objects, but not the one being created.
+         * @param[in] rrArgs   Argument lists for creating object
+         * @tparam    TFactory Factory type
+         * @tparam    TArgs    Variadic parameter types
+         * @return    Shared object pointer
+         */
+        template<class TFactory, class ... TArgs>
+        auto GetOrCreateShared(TArgs&& ... rrArgs) const
+            -> std::shared_ptr<const typename traits_details::get_factory_t<TFactory>::tObject>
+        {
+            // Helper types for shortening
+            using tObject = typename traits_details::get_factory_t<TFactory>::tObject;
+            using tKey    = std::tuple<cache_details::key_element_t<TArgs>...>;
+
+            auto& entry = GetEntry<TFactory>();
+
+            return entry.mSharedCache.template GetOrCreate<tObject>(tKey(std::forward<TArgs>(rrArgs)...),
+                                                                    [this](const tKey& rcKey)
+                                                                    {
+                                                                        return CreateObjectFromKey<TFactory, std::decay_t<TArgs>...>(rcKey, std::index_sequence_for<TArgs...>());
+                                                                    });
+        }
+
+        /**
+         * @brief     Set the maximum number of shared objects cached for a factory interface, for each list of argument types.
+         *            When exceeded, the least recently used objects are evicted from the cache.
+         *            The capacity is kept when the factory is overwritten. The cache belongs to the registered factory, so it's
+         *            shared with the forked injectors still sharing the factory and the capacity applies to them too.
+         *            FactoryNotRegisteredEx is thrown if the factory is not existent.
+         * @param[in] cCapacity Capacity, 0 for unbounded (default)
+         * @tparam    TFactory  Factory type
+         * @return    void
+         */
+        template<class TFactory>
+        void SetSharedCacheCapacity(const std::size_t cCapacity)
+        {
+            GetEntry<TFactory>().mSharedCache.SetCapacity(cCapacity);
+        }
+
+        /**
+         * @brief  Fork the injector. The forked injector shares all the registered factories with this one, but
+         *         registering or overwriting factories in one of them doesn't affect the other. Since registrations
+         *         are kept in a persistent map, forking is O(1) and each overwrite copies only the few nodes on
+         *         its path, so the memory used is proportional to the differences.
+         *         Shared factories (and their shared objects) are destroyed when the last injector using them is destroyed.
+         *         The injector shall not be modified while it's forked by another thread.
+         * @return Forked injector
+         */
+        std::unique_ptr<FactoryInjector> Fork(void) const
+        {
+            auto fork_ptr = std::make_unique<FactoryInjector>();
+            fork_ptr->mInstanceCont = mInstanceCont;
+#if defined(FACTORY_INJECTOR_ENABLE_TRACE)
+            fork_ptr->mpTraceRecorder = mpTraceRecorder;
+#endif
+            return fork_ptr;
+        }
+
+        /**
+         * @brief  Register all the factories declared with FACTORY_INJECTOR_STATIC_REGISTER in the module (executable or
+         *         shared library) including this call. Descriptors are placed in a linker section at build time,
+         *         so nothing is run during static initialization and there's no initialization order to care about.
+         *         Factories are registered in link order.
+         *         FactoryAlreadyRegisteredEx is thrown if a factory is already registered (e.g. if it's declared twice).
+         * @return Number of registered factories
+         */
+        std::size_t RegisterAllStatic(void)
+        {
+            const auto* p_begin = static_reg_details::GetBegin();
+            const auto* p_end   = static_reg_details::GetEnd();
+            if (p_begin == nullptr || p_end == nullptr)
+            {
+                return 0;
+            }
+
+            const auto count = static_cast<std::size_t>(p_end - p_begin);
+            for (const auto* p_reg = p_begin; p_reg != p_end; ++p_reg)
+            {
+                p_reg->mpRegister(*this);
+            }
+
+            return count;
+        }
+
+#if defined(FACTORY_INJECTOR_ENABLE_TRACE)
+        /**
+         * @brief     Set the trace recorder. GetFactory, CreateObject and factory registrations are recorded to it,
+         *            so they can be replayed offline (see benchmarks/trace_replay.cpp). The recorder shall outlive
+         *            the injector (or be reset before it's destroyed). Forked injectors keep recording to it.
+         *            Available only if FACTORY_INJECTOR_ENABLE_TRACE is defined.
+         * @param[in] pTraceRecorder Trace recorder, nullptr for disabling tracing
+         * @return    void
+         */
+        void SetTraceRecorder(TraceRecorder* pTraceRecorder)
+        {
+            mpTraceRecorder = pTraceRecorder;
+        }
+#endif
+
+#if defined(FACTORY_INJECTOR_ENABLE_ACCOUNTING)
+        /**
+         * @brief  Get a snapshot of the accounting information of all the registered factory interfaces.
+         *         Object counters are shared by all the injectors, since objects can outlive them, while the
+         *         registration size refers to this injector only.
+         *         Available only if FACTORY_INJECTOR_ENABLE_ACCOUNTING is defined.
+         * @return Accounting information
+         */
+        std::vector<FactoryAccountingInfo> GetAccountingSnapshot(void) const
         {
-            auto& factory = GetFactory<TFactory>();
+            std::vector<FactoryAccountingInfo> snapshot;
+            snapshot.reserve(mInstanceCont.Size());
+
+            mInstanceCont.ForEach([&snapshot](const std::type_index& rcTypeIdx,
+                                              const injector_details::InstanceEntry& rcEntry)
+            {
+                FactoryAccountingInfo info;
+                info.mInterfaceName     = rcTypeIdx.name();
+                info.mLiveObjects       = rcEntry.mpCounters->GetLiveObjects();
+                info.mCreatedObjects    = rcEntry.mpCounters->GetCreatedObjects();
+                info.mLiveBytes         = rcEntry.mpCounters->GetLiveBytes();
+                info.mCreatedBytes      = rcEntry.mpCounters->GetCreatedBytes();
+                // Container item and entry (excluding shared nodes) plus instance
+                info.mRegistrationBytes = tInstanceCont::GetItemSize() + sizeof(injector_details::InstanceEntry) + rcEntry.mInstancePtr->GetSize();
 
-            return factory.Create(std::forward<TArgs>(rrArgs)...);
+                snapshot.push_back(std::move(info));
+            });
+
+            return snapshot;
+        }
+#endif
+
+        /**
+         * @brief     Create a lazy range of objects from a factory, one for each element of the arguments range.
+         *            Each element is passed to the factory Create method, unpacked if it's a std::tuple.
+         *            The factory is resolved only once, then objects are created on demand while iterating the range,
+         *            in chunks of the specified size. The range is single-pass and objects can be moved out of it.
+         *            The factory shall not be overwritten while the range is used.
+         * @param[in] rrArgsRange Arguments range, it's kept by reference if it's an l-value
+         * @param[in] cChunkSize  Number of objects created at once
+         * @tparam    TFactory    Factory type
+         * @tparam    TArgsRange  Arguments range type
+         * @return    Object generator
+         */
+        template<class TFactory, class TArgsRange>
+        auto Generate(TArgsRange&& rrArgsRange,
+                      const std::size_t cChunkSize = 1) const
+            -> ObjectGenerator<traits_details::get_interface_t<TFactory>, TArgsRange, GeneratorCreator<TFactory>>
+        {
+            return ObjectGenerator<traits_details::get_interface_t<TFactory>, TArgsRange, GeneratorCreator<TFactory>>(GetFactory<TFactory>(),
+                                                                                                                      std::forward<TArgsRange>(rrArgsRange),
+                                                                                                                      cChunkSize,
+                                                                                                                      GeneratorCreator<TFactory>(*this));
         }
 
     /*
      * Private methods
      */
     private:
+        /**
+         * @brief     Register a factory by overwriting it, keeping alive the specified owner together with it.
+         * @param[in] ownerPtr Owner of the factory code, it can be empty
+         * @param[in] rrArgs   Argument lists for constructing factory
+         * @tparam    TFactory Factory type
+         * @tparam    TArgs    Variadic parameter types
+         * @return    void
+         */
+        template<class TFactory, class ... TArgs>
+        void EmplaceFactory(tOwnerPtr ownerPtr,
+                            TArgs&& ... rrArgs)
+        {
+            // Helper type for shortening
+            using tFactory = traits_details::get_factory_t<TFactory>;
+            // Auto-wire only factories that need constructor arguments, when none is given
+            using tAutoWire = std::integral_constant<bool, (sizeof...(TArgs) == 0) && !std::is_default_constructible<tFactory>::value>;
+
+#if defined(FACTORY_INJECTOR_ENABLE_TRACE)
+            // The factory construction is part of the recorded latency
+            const std::uint64_t start_ns = GetTraceTime();
+#endif
+            EmplaceFactoryImpl<TFactory>(tAutoWire(), std::move(ownerPtr), std::forward<TArgs>(rrArgs)...);
+#if defined(FACTORY_INJECTOR_ENABLE_TRACE)
+            RecordTraceEvent<TFactory>(TraceEventType::OverwriteFactory, start_ns);
+#endif
+        }
+
+        /**
+         * @brief     Register a factory by constructing it with the specified arguments.
+         * @param[in] ownerPtr Owner of the factory code, it can be empty
+         * @param[in] rrArgs   Argument lists for constructing factory
+         * @tparam    TFactory Factory type
+         * @tparam    TArgs    Variadic parameter types
+         * @return    void
+         */
+        template<class TFactory, class ... TArgs>
+        void EmplaceFactoryImpl(std::false_type,
+                                tOwnerPtr ownerPtr,
+                                TArgs&& ... rrArgs)
+        {
+            // Helper type for shortening
+            using tFactory = traits_details::get_factory_t<TFactory>;
+
+            EmplaceInstance<TFactory>(std::move(ownerPtr),
+                                      injector_details::MakeUniqueAnyInstance<tFactory>(std::forward<TArgs>(rrArgs)...));
+        }
+
+        /**
+         * @brief     Register a factory by auto-wiring its constructor parameters, that shall be constant references to
+         *            factory interfaces. Dependencies are resolved now, so FactoryNotRegisteredEx is thrown if one of them
+         *            is not existent, and they are kept alive together with the factory.
+         * @param[in] ownerPtr Owner of the factory code, it can be empty
+         * @tparam    TFactory Factory type
+         * @return    void
+         */
+        template<class TFactory>
+        void EmplaceFactoryImpl(std::true_type,
+                                tOwnerPtr ownerPtr)
+        {
+            // Helper type for shortening
+            using tFactory = traits_details::get_factory_t<TFactory>;
+
+            constexpr std::size_t arity = injector_details::auto_wire_arity<tFactory>::value;
+            static_assert(arity != 0,
+                          "The factory shall be default-constructible, or constructible from constant references to factory interfaces");
+
+            injector_details::AutoWireArg::tDependencies dependencies;
+            const injector_details::AutoWireArg auto_wire_arg(mInstanceCont, dependencies);
+
+            auto instance_ptr = MakeAutoWiredInstance<tFactory>(auto_wire_arg, std::make_index_sequence<arity>());
+            EmplaceInstance<TFactory>(std::move(ownerPtr), std::move(instance_ptr), std::move(dependencies));
+        }
+
+        /**
+         * @brief     Construct a factory instance by passing the auto-wiring argument for each constructor parameter.
+         * @param[in] rcAutoWireArg Auto-wiring argument
+         * @tparam    TFactory      Factory type
+         * @tparam    TIndexes      Parameter indexes
+         * @return    Factory instance
+         */
+        template<class TFactory, std::size_t ... TIndexes>
+        static tAnyInstancePtr MakeAutoWiredInstance(const injector_details::AutoWireArg& rcAutoWireArg,
+                                                     std::index_sequence<TIndexes...>)
+        {
+            return injector_details::MakeUniqueAnyInstance<TFactory>(GetAutoWireArg<TIndexes>(rcAutoWireArg)...);
+        }
+
+        /**
+         * @brief     Get the auto-wiring argument for a constructor parameter (helper for expanding it).
+         * @param[in] rcAutoWireArg Auto-wiring argument
+         * @tparam    TIndex        Parameter index
+         * @return    Auto-wiring argument
+         */
+        template<std::size_t TIndex>
+        static const injector_details::AutoWireArg& GetAutoWireArg(const injector_details::AutoWireArg& rcAutoWireArg)
+        {
+            return rcAutoWireArg;
+        }
+
+        /**
+         * @brief     Register an already constructed factory instance by overwriting it.
+         * @param[in] ownerPtr     Owner of the factory code, it can be empty
+         * @param[in] instancePtr  Factory instance
+         * @param[in] dependencies Entries referenced by the instance, they are kept alive with it
+         * @tparam    TFactory     Factory type
+         * @return    void
+         */
+        template<class TFactory>
+        void EmplaceInstance(tOwnerPtr ownerPtr,
+                             tAnyInstancePtr instancePtr,
+                             injector_details::AutoWireArg::tDependencies dependencies = {})
+        {
+            // Get interface type index
+            auto type_idx = GetInterfaceTypeIndex<TFactory>();
+
+            // Register or overwrite instance.
+            // The instance is already constructed, so nothing is inserted if its construction throws.
+            // A new entry is always created, so the previous one is left untouched for the forked injectors sharing it.
+            // When the previous entry is released, its cached objects and instance are destroyed before its owner.
+            auto entry_ptr = std::make_shared<injector_details::InstanceEntry>();
+            entry_ptr->mInstancePtr  = std::move(instancePtr);
+            entry_ptr->mDependencies = std::move(dependencies);
+            entry_ptr->mOwnerPtr     = std::move(ownerPtr);
+#if defined(FACTORY_INJECTOR_ENABLE_ACCOUNTING)
+            entry_ptr->mpCounters    = &accounting_details::GetInterfaceCounters<traits_details::get_interface_t<TFactory>>();
+#endif
+            // The cached objects are not kept, but the cache capacity is
+            const auto* p_prev_entry = mInstanceCont.Find(type_idx);
+            if (p_prev_entry != nullptr)
+            {
+                entry_ptr->mSharedCache.SetCapacity(p_prev_entry->mSharedCache.GetCapacity());
+            }
+
+            if (mInstanceCont.Set(type_idx, std::move(entry_ptr)))
+            {
+                FACTORY_INJECTOR_PROBE(register, traits_details::get_interface_t<TFactory>);
+            }
+            else
+            {
+                FACTORY_INJECTOR_PROBE(overwrite, traits_details::get_interface_t<TFactory>);
+            }
+        }
+
+        /**
+         * @brief  Get a factory instance without tracing it, see GetFactory.
+         * @tparam TFactory Factory type
+         * @return Constant reference to factory interface class
+         */
+        template<class TFactory>
+        auto ResolveFactory(void) const
+            -> traits_details::get_interface_const_ref_t<TFactory>
+        {
+            using tInterface = traits_details::get_interface_t<TFactory>;
+
+            FACTORY_INJECTOR_PROBE(lookup, tInterface);
+
+            // Find factory
+            const auto* p_entry = FindFactory<TFactory>();
+
+            // Return it if found
+            if (p_entry != nullptr)
+            {
+                return *static_cast<tInterface *>(p_entry->mInstancePtr->GetPtr());
+            }
+            else
+            {
+                FACTORY_INJECTOR_PROBE(miss, tInterface);
+                throw FactoryNotRegisteredEx(typeid(TFactory).name());
+            }
+        }
+
+        /**
+         * @brief     Create an object from an already resolved factory.
+         * @param[in] rcFactory Factory reference
+         * @param[in] rrArgs    Argument lists for creating object
+         * @tparam    TFactory  Factory type
+         * @tparam    TArgs     Variadic parameter types
+         * @return    Object pointer
+         */
+        template<class TFactory, class ... TArgs>
+        auto CreateFromFactory(const traits_details::get_interface_t<TFactory>& rcFactory,
+                               TArgs&& ... rrArgs) const
+            -> typename traits_details::get_factory_t<TFactory>::tObjectPtr
+        {
+#if defined(FACTORY_INJECTOR_ENABLE_TRACE)
+            const std::uint64_t start_ns = GetTraceTime();
+#endif
+            FACTORY_INJECTOR_PROBE(create_start, traits_details::get_interface_t<TFactory>);
+            auto obj_ptr = rcFactory.Create(std::forward<TArgs>(rrArgs)...);
+            FACTORY_INJECTOR_PROBE(create_end, traits_details::get_interface_t<TFactory>);
+#if defined(FACTORY_INJECTOR_ENABLE_TRACE)
+            RecordTraceEvent<TFactory>(TraceEventType::CreateObject, start_ns, GetArgsSize<TArgs...>());
+#endif
+
+#if defined(FACTORY_INJECTOR_ENABLE_ACCOUNTING)
+            if (obj_ptr)
+            {
+                obj_ptr.get_deleter().Track(accounting_details::GetInterfaceCounters<traits_details::get_interface_t<TFactory>>());
+            }
+#endif
+            return obj_ptr;
+        }
+
+        /**
+         * @brief     Create an object from an already resolved factory, with a single argument or a tuple of arguments.
+         * @param[in] rcFactory Factory reference
+         * @param[in] rrArgs    Argument or tuple of arguments
+         * @tparam    TFactory  Factory type
+         * @tparam    TArgs     Argument or tuple type
+         * @return    Object pointer
+         */
+        template<class TFactory, class TArgs>
+        auto CreateFromFactoryArgs(const traits_details::get_interface_t<TFactory>& rcFactory,
+                                   TArgs&& rrArgs) const
+            -> typename traits_details::get_factory_t<TFactory>::tObjectPtr
+        {
+            using tIsTuple = generator_details::is_tuple<traits_details::remove_const_ref_t<TArgs>>;
+
+            return CreateFromFactoryArgs<TFactory>(rcFactory, std::forward<TArgs>(rrArgs), tIsTuple());
+        }
+
+        /**
+         * @brief     Create an object from an already resolved factory with a tuple of arguments.
+         * @param[in] rcFactory Factory reference
+         * @param[in] rrArgs    Tuple of arguments
+         * @tparam    TFactory  Factory type
+         * @tparam    TArgs     Tuple type
+         * @return    Object pointer
+         */
+        template<class TFactory, class TArgs>
+        auto CreateFromFactoryArgs(const traits_details::get_interface_t<TFactory>& rcFactory,
+                                   TArgs&& rrArgs,
+                                   std::true_type) const
+            -> typename traits_details::get_factory_t<TFactory>::tObjectPtr
+        {
+            using tIndexes = std::make_index_sequence<std::tuple_size<traits_details::remove_const_ref_t<TArgs>>::value>;
+
+            return CreateFromFactoryTuple<TFactory>(rcFactory, std::forward<TArgs>(rrArgs), tIndexes());
+        }
+
+        /**
+         * @brief     Create an object from an already resolved factory with a single argument.
+         * @param[in] rcFactory Factory reference
+         * @param[in] rrArg     Argument
+         * @tparam    TFactory  Factory type
+         * @tparam    TArg      Argument type
+         * @return    Object pointer
+         */
+        template<class TFactory, class TArg>
+        auto CreateFromFactoryArgs(const traits_details::get_interface_t<TFactory>& rcFactory,
+                                   TArg&& rrArg,
+                                   std::false_type) const
+            -> typename traits_details::get_factory_t<TFactory>::tObjectPtr
+        {
+            return CreateFromFactory<TFactory>(rcFactory, std::forward<TArg>(rrArg));
+        }
+
+        /**
+         * @brief     Create an object from an already resolved factory, unpacking the arguments from a tuple.
+         * @param[in] rcFactory Factory reference
+         * @param[in] rrArgs    Tuple of arguments
+         * @tparam    TFactory  Factory type
+         * @tparam    TTuple    Tuple type
+         * @tparam    TIndexes  Tuple indexes
+         * @return    Object pointer
+         */
+        template<class TFactory, class TTuple, std::size_t ... TIndexes>
+        auto CreateFromFactoryTuple(const traits_details::get_interface_t<TFactory>& rcFactory,
+                                    TTuple&& rrArgs,
+                                    std::index_sequence<TIndexes...>) const
+            -> typename traits_details::get_factory_t<TFactory>::tObjectPtr
+        {
+            return CreateFromFactory<TFactory>(rcFactory, std::get<TIndexes>(std::forward<TTuple>(rrArgs))...);
+        }
+
+        /**
+         * @brief     Create an object from a factory, unpacking the arguments from a shared object key.
+         * @param[in] rcKey    Shared object key
+         * @tparam    TFactory Factory type
+         * @tparam    TArgs    Decayed argument types
+         * @tparam    TIndexes Key indexes
+         * @return    Object pointer
+         */
+        template<class TFactory, class ... TArgs, std::size_t ... TIndexes>
+        auto CreateObjectFromKey(const std::tuple<cache_details::key_element_t<TArgs>...>& rcKey,
+                                 std::index_sequence<TIndexes...>) const
+            -> typename traits_details::get_factory_t<TFactory>::tObjectPtr
+        {
+            return CreateObject<TFactory>(cache_details::KeyElement<TArgs>::ToArg(std::get<TIndexes>(rcKey))...);
+        }
+
+        /**
+         * @brief  Get the container entry of the specified factory type.
+         *         FactoryNotRegisteredEx is thrown if the factory is not existent.
+         * @tparam TFactory Factory type
+         * @return Constant reference to the entry
+         */
+        template<class TFactory>
+        const injector_details::InstanceEntry& GetEntry(void) const
+        {
+            FACTORY_INJECTOR_PROBE(lookup, traits_details::get_interface_t<TFactory>);
+
+            const auto* p_entry = FindFactory<TFactory>();
+            if (p_entry == nullptr)
+            {
+                FACTORY_INJECTOR_PROBE(miss, traits_details::get_interface_t<TFactory>);
+                throw FactoryNotRegisteredEx(typeid(TFactory).name());
+            }
+            return *p_entry;
+        }
+
+        /**
+         * @brief  Throw a FactoryAlreadyRegisteredEx exception if the specified factory type is already registered.
+         * @tparam TFactory Factory type
+         * @return void
+         */
+        template<class TFactory>
+        void ThrowIfRegistered(void) const
+        {
+            if (FindFactory<TFactory>() != nullptr)
+            {
+                throw FactoryAlreadyRegisteredEx(typeid(TFactory).name());
+            }
+        }
+
         /**
          * @brief  Find the specified factory type.
          * @tparam TFactory Factory type
-         * @return Constant iterator to the found factory
+         * @return Pointer to the found factory entry, nullptr if not found
          */
         template<class TFactory>
-        tInstanceContItr FindFactory(void) const
+        const injector_details::InstanceEntry* FindFactory(void) const
         {
             // Get interface type index
             auto type_idx = GetInterfaceTypeIndex<TFactory>();
 
             // Find instance
-            return mInstanceCont.find(type_idx);
+            return mInstanceCont.Find(type_idx);
         }
 
         /**
@@ -316,17 +1402,73 @@ class FactoryInjector final : public NotCopyMovable
         std::type_index GetInterfaceTypeIndex(void) const
         {
             // Helper types for shortening
-            using tInterface = typename traits_details::get_interface<TFactory>::type;
+            using tInterface = traits_details::get_interface_t<TFactory>;
 
             // Get type index
             return std::type_index(typeid(tInterface));
         }
 
+#if defined(FACTORY_INJECTOR_ENABLE_TRACE)
+        /**
+         * @brief  Get the current trace time
+         * @return Current trace time, 0 if tracing is disabled
+         */
+        std::uint64_t GetTraceTime(void) const
+        {
+            return (mpTraceRecorder != nullptr) ? mpTraceRecorder->Now() : 0;
+        }
+
+        /**
+         * @brief     Record a trace event, if tracing is enabled
+         * @param[in] cType     Event type
+         * @param[in] cStartNs  Start time, as returned by GetTraceTime
+         * @param[in] cArgBytes Size of the arguments, in bytes
+         * @tparam    TFactory  Factory type
+         * @return    void
+         */
+        template<class TFactory>
+        void RecordTraceEvent(const TraceEventType cType,
+                              const std::uint64_t cStartNs,
+                              const std::size_t cArgBytes = 0) const
+        {
+            if (mpTraceRecorder != nullptr)
+            {
+                // Helper type for shortening
+                using tInterface = traits_details::get_interface_t<TFactory>;
+
+                mpTraceRecorder->Record(cType,
+                                        trace_details::GetTypeId<tInterface>(),
+                                        cStartNs,
+                                        cArgBytes,
+                                        typeid(tInterface).name());
+            }
+        }
+
+        /**
+         * @brief  Get the total size of the arguments
+         * @tparam TArgs Variadic parameter types
+         * @return Size of the arguments, in bytes
+         */
+        template<class ... TArgs>
+        static constexpr std::size_t GetArgsSize(void)
+        {
+            std::size_t size = 0;
+            for (const std::size_t cArgSize : { std::size_t(0), sizeof(typename std::decay<TArgs>::type)... })
+            {
+                size += cArgSize;
+            }
+            return size;
+        }
+#endif
+
     /*
      * Members
      */
     private:
         tInstanceCont mInstanceCont;    /**< Instance container */
+#if defined(FACTORY_INJECTOR_ENABLE_TRACE)
+        TraceRecorder* mpTraceRecorder = nullptr;   /**< Trace recorder */
+#endif
 };
 
 }   // namespace factory_injector
@@ -0,0 +1,429 @@
+/**
+ * @copyright Copyright (c) 2020 Emanuele Bellocchia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file  factory_plugin.hpp
+ * @brief Declaration and definition of classes for loading factories from shared library plugins
+ *
+ */
+
+#ifndef _FACTORY_INJECTOR_FACTORY_PLUGIN_HPP_
+#define _FACTORY_INJECTOR_FACTORY_PLUGIN_HPP_
+
+/*
+ * Includes
+ */
+
+// Standard
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+// System
+#include <dlfcn.h>
+// Project
+#include "factory_injector.hpp"
+#include "not_copyable_movable.hpp"
+
+/*
+ * Macros
+ */
+
+/** Name of the registration entry point exported by plugins */
+#define FACTORY_INJECTOR_PLUGIN_ENTRY_NAME   "FactoryInjectorPluginRegister"
+
+/**
+ * @brief Define the registration entry point of a plugin, e.g.:
+ *            FACTORY_INJECTOR_PLUGIN(rRegistrar)
+ *            {
+ *                rRegistrar.OverwriteFactory<MyFactory>();
+ *            }
+ */
+#define FACTORY_INJECTOR_PLUGIN(registrar)                                                       \
+    static void FactoryInjectorPluginRegisterImpl(factory_injector::PluginRegistrar& registrar); \
+    extern "C" __attribute__((visibility("default")))                                            \
+    void FactoryInjectorPluginRegister(factory_injector::PluginRegistrar& rPluginRegistrar)      \
+    {                                                                                            \
+        factory_injector::plugin_details::GetModuleLibrary() = rPluginRegistrar.GetLibrary();    \
+        FactoryInjectorPluginRegisterImpl(rPluginRegistrar);                                     \
+    }                                                                                            \
+    static void FactoryInjectorPluginRegisterImpl(factory_injector::PluginRegistrar& registrar)
+
+/*
+ * Namespaces
+ */
+namespace factory_injector
+{
+
+/**
+ * @brief Policy for unloading a plugin library
+ */
+enum class PluginUnloadPolicy
+{
+    KeepLoaded,         /**< The library is never unloaded, so objects created by its factories can outlive them      */
+    UnloadWhenUnused,   /**< The library is unloaded by FactoryPluginLoader::UnloadUnused when none of its factories is
+                             registered anymore and no object created by them with the PluginDelete policy is alive. */
+};
+
+/*
+ * Namespaces
+ */
+namespace plugin_details
+{
+
+/**
+ * @brief  Get the library of the current module, i.e. the plugin whose entry point has been called last.
+ *         It's hidden, so each module (the application and every plugin) has its own copy.
+ * @return Library reference, it's empty in the application
+ */
+__attribute__((visibility("hidden")))
+inline std::weak_ptr<void>& GetModuleLibrary(void)
+{
+    static std::weak_ptr<void> module_library;
+
+    return module_library;
+}
+
+}   // namespace plugin_details
+
+/**
+ * @brief  Plugin deleter, it keeps the plugin library loaded until the object is deleted.
+ *         It can be implicitly constructed from std::default_delete, so plugin factories can keep returning
+ *         std::make_unique results.
+ * @tparam TObject Object type
+ */
+template<class TObject>
+class PluginDeleter
+{
+    /*
+     * Friend classes
+     */
+    template<class> friend class PluginDeleter;
+
+    /*
+     * Public methods
+     */
+    public:
+        /**
+         * @brief Constructor
+         */
+        PluginDeleter(void) noexcept = default;
+
+        /**
+         * @brief     Constructor from the default deleter of a derived type.
+         *            The object is created by the calling module, so it keeps alive its library (if any).
+         * @param[in] rcDeleter Default deleter
+         * @tparam    TDerived  Derived object type
+         */
+        template<class TDerived,
+                 std::enable_if_t<std::is_convertible<TDerived *, TObject *>::value, int> = 0>
+        PluginDeleter(const std::default_delete<TDerived>& rcDeleter) noexcept :
+            mLibraryPtr(plugin_details::GetModuleLibrary().lock())
+        {
+            static_cast<void>(rcDeleter);
+        }
+
+        /**
+         * @brief     Constructor from the plugin deleter of a derived type
+         * @param[in] rcDeleter Plugin deleter
+         * @tparam    TDerived  Derived object type
+         */
+        template<class TDerived,
+                 std::enable_if_t<std::is_convertible<TDerived *, TObject *>::value, int> = 0>
+        PluginDeleter(const PluginDeleter<TDerived>& rcDeleter) noexcept :
+            mLibraryPtr(rcDeleter.mLibraryPtr)
+        {}
+
+        /**
+         * @brief     Delete the object and release the library, since the deleter outlives it when the pointer is reset
+         * @param[in] pObject Object pointer
+         * @return    void
+         */
+        void operator()(TObject *pObject) const
+        {
+            static_assert(sizeof(TObject) > 0, "The object type shall be complete");
+
+            const auto library_ptr = std::move(mLibraryPtr);
+            delete pObject;
+        }
+
+    /*
+     * Members
+     */
+    private:
+        mutable std::shared_ptr<void> mLibraryPtr;   /**< Library of the module that created the object, empty if none */
+};
+
+/**
+ * @brief Plugin delete policy for factories.
+ *        Objects created by plugin factories keep the plugin library loaded, so that they can outlive the factories
+ *        also with PluginUnloadPolicy::UnloadWhenUnused.
+ */
+struct PluginDelete
+{
+    /** Deleter type definition */
+    template<class TObject>
+    using tDeleter = PluginDeleter<TObject>;
+};
+
+/**
+ * @brief Custom exception in case a plugin cannot be loaded
+ */
+class PluginLoadEx : public std::runtime_error
+{
+    /*
+     * Public methods
+     */
+    public:
+        /**
+         * @brief     Constructor
+         * @param[in] rcPluginPath Plugin path
+         * @param[in] rcReason     Failure reason
+         */
+        PluginLoadEx(const std::string& rcPluginPath,
+                     const std::string& rcReason) :
+            std::runtime_error("Unable to load plugin " + rcPluginPath + ": " + rcReason)
+        {}
+};
+
+/**
+ * @brief Plugin registrar class.
+ *        It's passed to the plugin entry point for registering the factories it provides.
+ *        Each registered factory keeps the plugin library loaded for as long as it's registered.
+ */
+class PluginRegistrar final : public NotCopyMovable
+{
+    /*
+     * Types
+     */
+    private:
+        /** Library pointer type definition */
+        using tLibraryPtr = std::shared_ptr<void>;
+
+    /**
+     * Public methods
+     */
+    public:
+        /**
+         * @brief     Constructor
+         * @param[in] rFactoryInjector Factory injector to register factories into
+         * @param[in] libraryPtr       Plugin library handle
+         */
+        PluginRegistrar(FactoryInjector& rFactoryInjector,
+                        tLibraryPtr libraryPtr) :
+            mrFactoryInjector(rFactoryInjector),
+            mLibraryPtr(std::move(libraryPtr))
+        {}
+
+        /**
+         * @brief     Register a factory by overwriting it, see FactoryInjector::OverwriteFactory.
+         * @param[in] rrArgs   Argument lists for constructing factory
+         * @tparam    TFactory Factory type
+         * @tparam    TArgs    Variadic parameter types
+         * @return    void
+         */
+        template<class TFactory, class ... TArgs>
+        void OverwriteFactory(TArgs&& ... rrArgs)
+        {
+            mrFactoryInjector.EmplaceFactory<TFactory>(mLibraryPtr, std::forward<TArgs>(rrArgs)...);
+        }
+
+        /**
+         * @brief     Same of OverwriteFactory method but, if the factory is already existent, a FactoryAlreadyRegisteredEx exception is thrown.
+         * @param[in] rrArgs   Argument lists for constructing factory
+         * @tparam    TFactory Factory type
+         * @tparam    TArgs    Variadic parameter types
+         * @return    void
+         */
+        template<class TFactory, class ... TArgs>
+        void RegisterFactory(TArgs&& ... rrArgs)
+        {
+            mrFactoryInjector.ThrowIfRegistered<TFactory>();
+            OverwriteFactory<TFactory>(std::forward<TArgs>(rrArgs)...);
+        }
+
+        /**
+         * @brief  Get the plugin library handle
+         * @return Library handle
+         */
+        const tLibraryPtr& GetLibrary(void) const
+        {
+            return mLibraryPtr;
+        }
+
+    /*
+     * Members
+     */
+    private:
+        FactoryInjector& mrFactoryInjector;     /**< Factory injector reference */
+        tLibraryPtr      mLibraryPtr;           /**< Plugin library handle      */
+};
+
+/**
+ * @brief Factory plugin loader class.
+ *        It loads a shared library and calls its registration entry point, defined by FACTORY_INJECTOR_PLUGIN.
+ *        The plugin and the application shall be compiled with the same library macros (e.g.
+ *        FACTORY_INJECTOR_ENABLE_ACCOUNTING, FACTORY_INJECTOR_ENABLE_TRACE), since they share the FactoryInjector
+ *        and its layout depends on them.
+ *        With PluginUnloadPolicy::KeepLoaded, loading again the same path returns the already loaded library,
+ *        so a new version of a plugin shall be loaded from a new path for hot-swapping it.
+ *        With PluginUnloadPolicy::UnloadWhenUnused:
+ *        - the application shall export its symbols (-rdynamic), so that plugins share its template static data
+ *          (e.g. accounting counters) instead of defining their own copy
+ *        - plugins shall be compiled with -fno-gnu-unique (GCC), otherwise that data is made of STB_GNU_UNIQUE
+ *          symbols and glibc never unloads a library defining them
+ *        - libraries are closed only by UnloadUnused, so that dlclose never runs from the plugin code being unmapped
+ */
+class FactoryPluginLoader final : public NotCopyMovable
+{
+    /*
+     * Types
+     */
+    private:
+        /** Plugin entry point type definition */
+        using tEntryPoint = void (*)(PluginRegistrar&);
+
+    /**
+     * Public methods
+     */
+    public:
+        /**
+         * @brief     Load a plugin and register its factories. A PluginLoadEx exception is thrown in case of errors.
+         * @param[in] rFactoryInjector Factory injector to register factories into
+         * @param[in] rcPluginPath     Plugin path
+         * @param[in] cUnloadPolicy    Unload policy
+         * @return    void
+         */
+        static void Load(FactoryInjector& rFactoryInjector,
+                         const std::string& rcPluginPath,
+                         const PluginUnloadPolicy cUnloadPolicy = PluginUnloadPolicy::KeepLoaded)
+        {
+            // Open library, RTLD_NODELETE prevents dlclose from unloading it
+            int flags = RTLD_NOW | RTLD_LOCAL;
+            if (cUnloadPolicy == PluginUnloadPolicy::KeepLoaded)
+            {
+                flags |= RTLD_NODELETE;
+            }
+
+            void *p_handle = dlopen(rcPluginPath.c_str(), flags);
+            if (p_handle == nullptr)
+            {
+                throw PluginLoadEx(rcPluginPath, dlerror());
+            }
+
+            // The library is queued for unloading when the last factory or object using it is released,
+            // that may happen within the plugin code
+            std::shared_ptr<void> library_ptr(p_handle, [](void *pHandle) { GetUnloadQueue().Push(pHandle); });
+
+            // Find entry point
+            auto entry_point = reinterpret_cast<tEntryPoint>(dlsym(p_handle, FACTORY_INJECTOR_PLUGIN_ENTRY_NAME));
+            if (entry_point == nullptr)
+            {
+                throw PluginLoadEx(rcPluginPath, "entry point " FACTORY_INJECTOR_PLUGIN_ENTRY_NAME " not found");
+            }
+
+            // Register factories
+            PluginRegistrar registrar(rFactoryInjector, std::move(library_ptr));
+            entry_point(registrar);
+        }
+
+        /**
+         * @brief  Close the libraries whose factories and objects have been released.
+         *         It shall be called by the application code (e.g. after overwriting the factories of a plugin),
+         *         never by plugin code.
+         * @return Number of closed libraries
+         */
+        static std::size_t UnloadUnused(void)
+        {
+            auto handles = GetUnloadQueue().PopAll();
+            for (auto* p_handle : handles)
+            {
+                dlclose(p_handle);
+            }
+            return handles.size();
+        }
+
+    /*
+     * Types
+     */
+    private:
+        /**
+         * @brief Queue of the library handles to close
+         */
+        class UnloadQueue final : public NotCopyMovable
+        {
+            public:
+                /**
+                 * @brief     Push a library handle, the library is kept loaded if it cannot be queued
+                 * @param[in] pHandle Library handle
+                 * @return    void
+                 */
+                void Push(void *pHandle) noexcept
+                {
+                    std::lock_guard<std::mutex> lock(mMutex);
+                    try
+                    {
+                        mHandles.push_back(pHandle);
+                    }
+                    catch (...)
+                    {
+                        // Keep the library loaded
+                    }
+                }
+
+                /**
+                 * @brief  Pop all the library handles
+                 * @return Library handles
+                 */
+                std::vector<void *> PopAll(void)
+                {
+                    std::vector<void *> handles;
+                    std::lock_guard<std::mutex> lock(mMutex);
+                    handles.swap(mHandles);
+                    return handles;
+                }
+
+            private:
+                std::mutex          mMutex;     /**< Mutex for the handles */
+                std::vector<void *> mHandles;   /**< Library handles       */
+        };
+
+    /*
+     * Private methods
+     */
+    private:
+        /**
+         * @brief  Get the unload queue
+         * @return Unload queue reference
+         */
+        static UnloadQueue& GetUnloadQueue(void)
+        {
+            static UnloadQueue unload_queue;
+
+            return unload_queue;
+        }
+};
+
+}   // namespace factory_injector
+
+#endif  // _FACTORY_INJECTOR_FACTORY_PLUGIN_HPP_
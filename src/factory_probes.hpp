@@ -0,0 +1,133 @@
+/**
+ * @copyright Copyright (c) 2020 Emanuele Bellocchia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file  factory_probes.hpp
+ * @brief USDT probes (SystemTap-compatible) for tracing factory lookups, creations and registrations with tools
+ *        like bpftrace or perf. They are compiled in only if FACTORY_INJECTOR_ENABLE_USDT is defined, otherwise
+ *        they expand to nothing. A compiled-in probe is a single nop until a tracer is attached to it.
+ *        Probes (provider factory_injector): lookup, miss, create_start, create_end, register, overwrite.
+ *        Arguments: interface name (const char*), interface type id (std::size_t, hash code of the type).
+ *
+ */
+
+#ifndef _FACTORY_INJECTOR_FACTORY_PROBES_HPP_
+#define _FACTORY_INJECTOR_FACTORY_PROBES_HPP_
+
+/*
+ * Includes
+ */
+
+// Standard
+#include <cstddef>
+#include <typeinfo>
+
+/*
+ * Macros
+ */
+
+#if defined(FACTORY_INJECTOR_ENABLE_USDT) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+// Use the system header
+#include <sys/sdt.h>
+/** Probes are enabled */
+#define FACTORY_INJECTOR_USDT_ENABLED    1
+/** Probe implementation */
+#define FACTORY_INJECTOR_PROBE_IMPL(probe, arg1, arg2)    DTRACE_PROBE2(factory_injector, probe, arg1, arg2)
+#elif defined(__GNUC__) && defined(__ELF__) && defined(__x86_64__)
+/** Probes are enabled */
+#define FACTORY_INJECTOR_USDT_ENABLED    1
+/** Probe implementation, it emits the same note of sys/sdt.h (version 3), so that it can be used without systemtap headers.
+    Arguments are memory operands, so the compiler never loads them into registers. */
+#define FACTORY_INJECTOR_PROBE_IMPL(probe, arg1, arg2)                                  \
+    __asm__ __volatile__ ("990: nop\n"                                                  \
+                          ".pushsection .note.stapsdt,\"?\",\"note\"\n"                 \
+                          ".balign 4\n"                                                 \
+                          ".4byte 992f-991f, 994f-993f, 3\n"                            \
+                          "991: .asciz \"stapsdt\"\n"                                   \
+                          "992: .balign 4\n"                                            \
+                          "993: .8byte 990b\n"                                          \
+                          ".8byte _.stapsdt.base\n"                                     \
+                          ".8byte 0\n"                                                  \
+                          ".asciz \"factory_injector\"\n"                               \
+                          ".asciz \"" #probe "\"\n"                                     \
+                          ".asciz \"8@%0 8@%1\"\n"                                      \
+                          "994: .balign 4\n"                                            \
+                          ".popsection\n"                                               \
+                          ".ifndef _.stapsdt.base\n"                                    \
+                          ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n" \
+                          ".weak _.stapsdt.base\n"                                      \
+                          ".hidden _.stapsdt.base\n"                                    \
+                          "_.stapsdt.base: .space 1\n"                                  \
+                          ".size _.stapsdt.base, 1\n"                                   \
+                          ".popsection\n"                                               \
+                          ".endif\n"                                                    \
+                          :: "m" (arg1), "m" (arg2))
+#endif
+#endif
+
+#if defined(FACTORY_INJECTOR_USDT_ENABLED)
+/**
+ * Fire a probe for a factory interface.
+ * Arguments are read from static variables, so no code is needed to prepare them.
+ */
+#define FACTORY_INJECTOR_PROBE(probe, TInterface)                                       \
+    FACTORY_INJECTOR_PROBE_IMPL(probe,                                                  \
+                                ::factory_injector::probe_details::ProbeInfo<TInterface>::kpName, \
+                                ::factory_injector::probe_details::ProbeInfo<TInterface>::kTypeId)
+#else
+/** Probes are disabled */
+#define FACTORY_INJECTOR_USDT_ENABLED    0
+/** Fire a probe for a factory interface (disabled) */
+#define FACTORY_INJECTOR_PROBE(probe, TInterface)    ((void) 0)
+#endif
+
+/*
+ * Namespaces
+ */
+namespace factory_injector
+{
+
+/* Internal namespace, shall not be used */
+namespace probe_details
+{
+
+/**
+ * @brief  Probe arguments of a factory interface, computed once at startup
+ * @tparam TInterface Factory interface type
+ */
+template<class TInterface>
+struct ProbeInfo
+{
+    static const char* const kpName;      /**< Interface name    */
+    static const std::size_t kTypeId;     /**< Interface type id */
+};
+
+template<class TInterface>
+const char* const ProbeInfo<TInterface>::kpName = typeid(TInterface).name();
+
+template<class TInterface>
+const std::size_t ProbeInfo<TInterface>::kTypeId = typeid(TInterface).hash_code();
+
+}   // namespace probe_details
+
+}   // namespace factory_injector
+
+#endif  // _FACTORY_INJECTOR_FACTORY_PROBES_HPP_
@@ -27,6 +27,18 @@
 #ifndef _FACTORY_INJECTOR_FACTORY_TRAITS_HPP_
 #define _FACTORY_INJECTOR_FACTORY_TRAITS_HPP_
 
+/*
+ * Includes
+ */
+
+// Standard
+#include <memory>
+#include <type_traits>
+// Project
+#if defined(FACTORY_INJECTOR_ENABLE_ACCOUNTING)
+#include "factory_accounting.hpp"
+#endif
+
 /*
  * Namespaces
  */
@@ -37,80 +49,104 @@ namespace factory_injector
 namespace traits_details
 {
 
+/*
+ * The helpers are alias templates instead of nested structures, so that they do not
+ * produce a class instantiation for each factory type in each translation unit.
+ */
+
 /**
- * @brief  Helper struct for adding const reference to a type
+ * @brief  Helper alias for adding const reference to a type
  * @tparam T Class type
  */
 template<class T>
-struct add_const_ref
-{
-    /** Type with constant reference */
-    using type = typename std::add_const<typename std::add_lvalue_reference<T>::type>::type;
-};
+using add_const_ref_t = std::add_const_t<std::add_lvalue_reference_t<T>>;
 
 /**
- * @brief  Helper struct for removing const reference from a type
+ * @brief  Helper alias for removing const reference from a type
  * @tparam T Class type
  */
 template<class T>
-struct remove_const_ref
-{
-    /** Type without constant reference */
-    using type = typename std::remove_cv<typename std::remove_reference<T>::type>::type;
-};
+using remove_const_ref_t = std::remove_cv_t<std::remove_reference_t<T>>;
 
 /**
- * @brief  Helper struct for getting the pure factory type from a factory type
+ * @brief  Helper alias for getting the pure factory type from a factory type
  * @tparam TFactory Factory type
  */
 template<class TFactory>
-struct get_factory
-{
-    /** Cleaned factory type */
-    using type = typename remove_const_ref<TFactory>::type;
-};
+using get_factory_t = remove_const_ref_t<TFactory>;
 
 /**
- * @brief  Helper struct for getting the interface type from a factory type
+ * @brief  Helper alias for getting the interface type from a factory type
  * @tparam TFactory Factory type
  */
 template<class TFactory>
-struct get_interface
-{
-    /** Interface type */
-    using type = typename get_factory<TFactory>::type::tInterface;
-};
+using get_interface_t = typename get_factory_t<TFactory>::tInterface;
 
 /**
- * @brief  Helper struct for getting constant reference interface type from a factory type
+ * @brief  Helper alias for getting constant reference interface type from a factory type
  * @tparam TFactory Factory type
  */
 template<class TFactory>
-struct get_interface_const_ref
-{
-    /** Factory constant reference interface type */
-    using type = typename add_const_ref<typename get_interface<TFactory>::type>::type;
-};
+using get_interface_const_ref_t = add_const_ref_t<get_interface_t<TFactory>>;
+
+/**
+ * @brief  Helper alias that maps any type to void, for detecting members
+ * @tparam T Class type
+ */
+template<class T>
+using void_t = std::conditional_t<true, void, T>;
+
+/**
+ * @brief  Helper struct for checking if a type is a factory interface (i.e. it's its own interface type)
+ * @tparam T Class type
+ */
+template<class T, class = void>
+struct is_factory_interface : std::false_type
+{};
+
+/**
+ * @brief  Helper struct for checking if a type is a factory interface (specialization for types with FactoryTraits)
+ * @tparam T Class type
+ */
+template<class T>
+struct is_factory_interface<T, void_t<typename T::tInterface>> : std::is_same<T, typename T::tInterface>
+{};
 
 }
 
+/**
+ * @brief Default delete policy for factories, objects are deleted immediately by std::default_delete
+ */
+struct DefaultDelete
+{
+    /** Deleter type definition */
+    template<class TObject>
+    using tDeleter = std::default_delete<TObject>;
+};
+
 /**
  * @brief  Type traits for factories.
  *         It defines the needed types for factories that need to be injected.
  *         The interface of these factories shall inherit from this structure.
- * @tparam TInterface Interface type
- * @tparam TObject    Object type
+ * @tparam TInterface    Interface type
+ * @tparam TObject       Object type
+ * @tparam TDeletePolicy Delete policy, it defines the deleter of the object pointer (e.g. DeferredDelete)
  */
-template<class TInterface, class TObject>
+template<class TInterface, class TObject, class TDeletePolicy = DefaultDelete>
 struct FactoryTraits
 {
     /*
      * Types
      */
 
-    using tInterface = typename traits_details::remove_const_ref<TInterface>::type;  /**< Interface class type */
-    using tObject    = typename traits_details::remove_const_ref<TObject>::type;     /**< Object type          */
-    using tObjectPtr = std::unique_ptr<tObject>;                                     /**< Object pointer type  */
+    using tInterface = traits_details::remove_const_ref_t<TInterface>;   /**< Interface class type */
+    using tObject    = traits_details::remove_const_ref_t<TObject>;      /**< Object type          */
+    using tDeleter   = typename TDeletePolicy::template tDeleter<tObject>;    /**< Object deleter type  */
+#if defined(FACTORY_INJECTOR_ENABLE_ACCOUNTING)
+    using tObjectPtr = std::unique_ptr<tObject, AccountingDeleter<tObject, tDeleter>>;  /**< Object pointer type  */
+#else
+    using tObjectPtr = std::unique_ptr<tObject, tDeleter>;              /**< Object pointer type  */
+#endif
 };
 
 }   // namespace factory_injector
@@ -0,0 +1,477 @@
+/**
+ * @copyright Copyright (c) 2020 Emanuele Bellocchia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file  fixed_factory_injector.hpp
+ * @brief Declaration and definition of FixedFactoryInjector class, a factory injector that never allocates memory
+ *
+ */
+
+#ifndef _FACTORY_INJECTOR_FIXED_FACTORY_INJECTOR_HPP_
+#define _FACTORY_INJECTOR_FIXED_FACTORY_INJECTOR_HPP_
+
+/*
+ * Includes
+ */
+
+// Standard
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <new>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+// Project
+#include "factory_injector.hpp"
+
+/*
+ * Namespaces
+ */
+namespace factory_injector
+{
+
+/* Internal namespace, shall not be used */
+namespace fixed_details
+{
+
+/**
+ * @brief     Get the smallest power of 2 greater than or equal to a value
+ * @param[in] cValue Value
+ * @return    Power of 2
+ */
+constexpr std::size_t NextPow2(const std::size_t cValue)
+{
+    return (cValue <= 1) ? 1 : 2 * NextPow2((cValue + 1) / 2);
+}
+
+}   // namespace fixed_details
+
+/**
+ * @brief Custom exception in case the capacity of a fixed factory injector is exceeded.
+ *        The message is a string literal, so no memory is allocated for it.
+ */
+class FactoryCapacityExceededEx : public std::exception
+{
+    /*
+     * Public methods
+     */
+    public:
+        /**
+         * @brief     Constructor
+         * @param[in] pcMessage Message, it shall be a string literal
+         */
+        explicit FactoryCapacityExceededEx(const char* pcMessage) noexcept :
+            mpcMessage(pcMessage)
+        {}
+
+        /**
+         * @brief  Get the message
+         * @return Message
+         */
+        const char* what(void) const noexcept override
+        {
+            return mpcMessage;
+        }
+
+    /*
+     * Members
+     */
+    private:
+        const char* mpcMessage;     /**< Message */
+};
+
+/**
+ * @brief Result of the FixedFactoryInjector::TryRegisterFactory and FixedFactoryInjector::TryOverwriteFactory methods
+ */
+enum class FixedRegisterResult
+{
+    Registered        = 0,  /**< Factory registered              */
+    Overwritten       = 1,  /**< Factory overwritten             */
+    AlreadyRegistered = 2,  /**< Factory already registered      */
+    CapacityExceeded  = 3,  /**< Capacity exceeded, nothing done */
+    StorageExceeded   = 4,  /**< Storage exceeded, nothing done  */
+};
+
+/**
+ * @brief  Fixed factory injector class.
+ *         Same of FactoryInjector, but factories are constructed inline in a statically sized buffer and found with
+ *         a fixed-size open-addressing index, so it never allocates memory (e.g. for real-time threads).
+ *         Exceeding the capacity or the storage throws FactoryCapacityExceededEx (throwing still allocates the exception
+ *         object through the C++ runtime), while the TryRegisterFactory and TryOverwriteFactory methods return a result instead.
+ *         The storage of an overwritten factory is reused if the new factory fits in it and it's nothrow constructible.
+ *         Otherwise the new factory is constructed before destroying the previous one, in new storage: the storage of
+ *         the previous factory is reclaimed only if it's the last allocated one (e.g. when the same factory is overwritten
+ *         repeatedly), so overwriting other factories this way consumes storage until the injector is destroyed.
+ *         Objects are still allocated by the factories Create methods.
+ * @tparam TCapacity     Maximum number of factory interfaces
+ * @tparam TStorageBytes Storage size for the factories, in bytes
+ */
+template<std::size_t TCapacity, std::size_t TStorageBytes>
+class FixedFactoryInjector final : public NotCopyMovable
+{
+    static_assert(TCapacity > 0, "The capacity shall be greater than zero");
+
+    /*
+     * Types
+     */
+    private:
+        /** Destroyer function type definition */
+        using tDestroyer = void (*)(void *);
+
+        /**
+         * @brief Index slot
+         */
+        struct Slot
+        {
+            const std::type_info* mpType       = nullptr;   /**< Interface type, nullptr if the slot is empty */
+            void*                 mpInterface  = nullptr;   /**< Pointer to the factory interface             */
+            void*                 mpFactory    = nullptr;   /**< Pointer to the factory                       */
+            tDestroyer            mpDestroyer  = nullptr;   /**< Factory destroyer                            */
+            unsigned char*        mpBlock      = nullptr;   /**< Start of the storage owned by the slot       */
+            unsigned char*        mpStorage    = nullptr;   /**< Storage of the factory                       */
+            std::size_t           mStorageSize = 0;         /**< Storage size of the factory                  */
+        };
+
+    /*
+     * Constants
+     */
+    private:
+        /** Index size, it's kept at most half full */
+        static constexpr std::size_t kIndexSize = fixed_details::NextPow2(2 * TCapacity);
+
+    /*
+     * Public methods
+     */
+    public:
+        /**
+         * @brief Constructor
+         */
+        FixedFactoryInjector(void) = default;
+
+        /**
+         * @brief Destructor
+         */
+        ~FixedFactoryInjector(void)
+        {
+            for (auto& slot : mIndex)
+            {
+                if (slot.mpType != nullptr)
+                {
+                    slot.mpDestroyer(slot.mpFactory);
+                }
+            }
+        }
+
+        /**
+         * @brief     Register a factory by overwriting it, see FactoryInjector::OverwriteFactory.
+         *            FactoryCapacityExceededEx is thrown if there's no space for the factory.
+         * @param[in] rrArgs   Argument lists for constructing factory
+         * @tparam    TFactory Factory type
+         * @tparam    TArgs    Variadic parameter types
+         * @return    void
+         */
+        template<class TFactory, class ... TArgs>
+        void OverwriteFactory(TArgs&& ... rrArgs)
+        {
+            ThrowIfExceeded(TryOverwriteFactory<TFactory>(std::forward<TArgs>(rrArgs)...));
+        }
+
+        /**
+         * @brief     Same of OverwriteFactory method but, if the factory is already existent, a FactoryAlreadyRegisteredEx exception is thrown.
+         * @param[in] rrArgs   Argument lists for constructing factory
+         * @tparam    TFactory Factory type
+         * @tparam    TArgs    Variadic parameter types
+         * @return    void
+         */
+        template<class TFactory, class ... TArgs>
+        void RegisterFactory(TArgs&& ... rrArgs)
+        {
+            const FixedRegisterResult cResult = TryRegisterFactory<TFactory>(std::forward<TArgs>(rrArgs)...);
+            if (cResult == FixedRegisterResult::AlreadyRegistered)
+            {
+                throw FactoryAlreadyRegisteredEx(typeid(TFactory).name());
+            }
+            ThrowIfExceeded(cResult);
+        }
+
+        /**
+         * @brief     Same of OverwriteFactory method but, instead of throwing, the result is returned.
+         *            It doesn't allocate memory and it only throws if the factory constructor throws.
+         * @param[in] rrArgs   Argument lists for constructing factory
+         * @tparam    TFactory Factory type
+         * @tparam    TArgs    Variadic parameter types
+         * @return    FixedRegisterResult::Registered or FixedRegisterResult::Overwritten if succeeded,
+         *            FixedRegisterResult::CapacityExceeded or FixedRegisterResult::StorageExceeded otherwise
+         */
+        template<class TFactory, class ... TArgs>
+        FixedRegisterResult TryOverwriteFactory(TArgs&& ... rrArgs)
+            noexcept(std::is_nothrow_constructible<traits_details::get_factory_t<TFactory>, TArgs&&...>::value)
+        {
+            // Helper types for shortening
+            using tFactory   = traits_details::get_factory_t<TFactory>;
+            using tInterface = traits_details::get_interface_t<TFactory>;
+
+            static_assert(alignof(tFactory) <= alignof(std::max_align_t), "The factory alignment is not supported");
+            static_assert(sizeof(tFactory) <= TStorageBytes, "The factory is bigger than the storage");
+
+            Slot* p_slot = FindSlot(typeid(tInterface));
+            if ((p_slot->mpType == nullptr) && (mCount == TCapacity))
+            {
+                return FixedRegisterResult::CapacityExceeded;
+            }
+
+            tFactory* p_factory = nullptr;
+            if ((p_slot->mpType != nullptr) &&
+                std::is_nothrow_constructible<tFactory, TArgs&&...>::value &&
+                FitsIn<tFactory>(p_slot->mpStorage, p_slot->mStorageSize))
+            {
+                // Reuse the storage of the previous factory, the new one cannot throw
+                p_slot->mpDestroyer(p_slot->mpFactory);
+                p_factory = ::new (static_cast<void *>(p_slot->mpStorage)) tFactory(std::forward<TArgs>(rrArgs)...);
+            }
+            else
+            {
+                // If the slot owns the last allocated storage, the space before its factory (left by a previous overwrite)
+                // is used if the new factory fits in it, otherwise new storage is allocated
+                const bool cLast = (p_slot->mpType != nullptr) &&
+                                   (p_slot->mpStorage + p_slot->mStorageSize == mStorage + mStorageUsed);
+                std::size_t offset = cLast ? AlignOffset<tFactory>(static_cast<std::size_t>(p_slot->mpBlock - mStorage)) : 0;
+                if (!cLast || (mStorage + offset + sizeof(tFactory) > p_slot->mpStorage))
+                {
+                    offset = AlignOffset<tFactory>(mStorageUsed);
+                }
+                if (offset + sizeof(tFactory) > TStorageBytes)
+                {
+                    return FixedRegisterResult::StorageExceeded;
+                }
+
+                // Construct the factory, nothing is changed if it throws
+                p_factory = ::new (static_cast<void *>(mStorage + offset)) tFactory(std::forward<TArgs>(rrArgs)...);
+
+                // Destroy the previous factory, if any. If it was the last allocated one, its storage is reclaimed
+                // (the slot keeps owning the space before the new factory, if any).
+                if (p_slot->mpType != nullptr)
+                {
+                    p_slot->mpDestroyer(p_slot->mpFactory);
+                }
+                if (!cLast)
+                {
+                    p_slot->mpBlock = mStorage + offset;
+                }
+                mStorageUsed         = offset + sizeof(tFactory);
+                p_slot->mpStorage    = mStorage + offset;
+                p_slot->mStorageSize = sizeof(tFactory);
+            }
+
+            const bool cOverwritten = (p_slot->mpType != nullptr);
+            if (cOverwritten)
+            {
+                FACTORY_INJECTOR_PROBE(overwrite, tInterface);
+            }
+            else
+            {
+                mCount++;
+                FACTORY_INJECTOR_PROBE(register, tInterface);
+            }
+
+            p_slot->mpType      = &typeid(tInterface);
+            p_slot->mpInterface = static_cast<tInterface *>(p_factory);
+            p_slot->mpFactory   = p_factory;
+            p_slot->mpDestroyer = [](void *pFactory) { static_cast<tFactory *>(pFactory)->~tFactory(); };
+
+            return cOverwritten ? FixedRegisterResult::Overwritten : FixedRegisterResult::Registered;
+        }
+
+        /**
+         * @brief     Same of RegisterFactory method but, instead of throwing, the result is returned.
+         *            It doesn't allocate memory and it only throws if the factory constructor throws.
+         * @param[in] rrArgs   Argument lists for constructing factory
+         * @tparam    TFactory Factory type
+         * @tparam    TArgs    Variadic parameter types
+         * @return    FixedRegisterResult::Registered if succeeded, FixedRegisterResult::AlreadyRegistered,
+         *            FixedRegisterResult::CapacityExceeded or FixedRegisterResult::StorageExceeded otherwise
+         */
+        template<class TFactory, class ... TArgs>
+        FixedRegisterResult TryRegisterFactory(TArgs&& ... rrArgs)
+            noexcept(std::is_nothrow_constructible<traits_details::get_factory_t<TFactory>, TArgs&&...>::value)
+        {
+            using tInterface = traits_details::get_interface_t<TFactory>;
+
+            if (FindSlot(typeid(tInterface))->mpType != nullptr)
+            {
+                return FixedRegisterResult::AlreadyRegistered;
+            }
+            return TryOverwriteFactory<TFactory>(std::forward<TArgs>(rrArgs)...);
+        }
+
+        /**
+         * @brief  Get a factory instance, see FactoryInjector::GetFactory.
+         *         FactoryNotRegisteredEx is thrown if the factory is not existent.
+         * @tparam TFactory Factory type
+         * @return Constant reference to factory interface class
+         */
+        template<class TFactory>
+        auto GetFactory(void) const
+            -> traits_details::get_interface_const_ref_t<TFactory>
+        {
+            using tInterface = traits_details::get_interface_t<TFactory>;
+
+            FACTORY_INJECTOR_PROBE(lookup, tInterface);
+
+            const Slot* p_slot = FindSlot(typeid(tInterface));
+            if (p_slot->mpType == nullptr)
+            {
+                FACTORY_INJECTOR_PROBE(miss, tInterface);
+                throw FactoryNotRegisteredEx(typeid(TFactory).name());
+            }
+            return *static_cast<tInterface *>(p_slot->mpInterface);
+        }
+
+        /**
+         * @brief     Create an object from a factory, see FactoryInjector::CreateObject.
+         * @param[in] rrArgs   Argument lists for constructing object
+         * @tparam    TFactory Factory type
+         * @tparam    TArgs    Variadic parameter types
+         * @return    Object pointer
+         */
+        template<class TFactory, class ... TArgs>
+        auto CreateObject(TArgs&& ... rrArgs) const
+            -> typename traits_details::get_factory_t<TFactory>::tObjectPtr
+        {
+            auto& factory = GetFactory<TFactory>();
+
+            FACTORY_INJECTOR_PROBE(create_start, traits_details::get_interface_t<TFactory>);
+            auto obj_ptr = factory.Create(std::forward<TArgs>(rrArgs)...);
+            FACTORY_INJECTOR_PROBE(create_end, traits_details::get_interface_t<TFactory>);
+
+#if defined(FACTORY_INJECTOR_ENABLE_ACCOUNTING)
+            if (obj_ptr)
+            {
+                obj_ptr.get_deleter().Track(accounting_details::GetInterfaceCounters<traits_details::get_interface_t<TFactory>>());
+            }
+#endif
+            return obj_ptr;
+        }
+
+        /**
+         * @brief  Get the number of registered factory interfaces
+         * @return Number of registered factory interfaces
+         */
+        std::size_t GetFactoryCount(void) const
+        {
+            return mCount;
+        }
+
+        /**
+         * @brief  Get the used storage, useful for sizing it
+         * @return Used storage in bytes
+         */
+        std::size_t GetUsedStorage(void) const
+        {
+            return mStorageUsed;
+        }
+
+    /*
+     * Private methods
+     */
+    private:
+        /**
+         * @brief     Throw FactoryCapacityExceededEx if the capacity or the storage was exceeded
+         * @param[in] cResult Registration result
+         * @return    void
+         */
+        static void ThrowIfExceeded(const FixedRegisterResult cResult)
+        {
+            if (cResult == FixedRegisterResult::CapacityExceeded)
+            {
+                throw FactoryCapacityExceededEx("Fixed factory injector capacity exceeded");
+            }
+            if (cResult == FixedRegisterResult::StorageExceeded)
+            {
+                throw FactoryCapacityExceededEx("Fixed factory injector storage exceeded");
+            }
+        }
+
+        /**
+         * @brief     Align a storage offset for a factory
+         * @param[in] cOffset  Storage offset
+         * @tparam    TFactory Factory type
+         * @return    Aligned storage offset
+         */
+        template<class TFactory>
+        static std::size_t AlignOffset(const std::size_t cOffset)
+        {
+            return (cOffset + alignof(TFactory) - 1) & ~(alignof(TFactory) - 1);
+        }
+
+        /**
+         * @brief     Get if a factory fits in the storage of a previous factory
+         * @param[in] pStorage     Storage
+         * @param[in] cStorageSize Storage size
+         * @tparam    TFactory     Factory type
+         * @return    True if it fits, false otherwise
+         */
+        template<class TFactory>
+        static bool FitsIn(unsigned char* pStorage,
+                           const std::size_t cStorageSize)
+        {
+            return ((reinterpret_cast<std::uintptr_t>(pStorage) % alignof(TFactory)) == 0) &&
+                   (sizeof(TFactory) <= cStorageSize);
+        }
+
+        /**
+         * @brief     Find the slot of an interface type, by linear probing
+         * @param[in] rcType Interface type
+         * @return    Pointer to the slot of the interface if found, otherwise to the empty slot where it can be inserted
+         */
+        Slot* FindSlot(const std::type_info& rcType)
+        {
+            std::size_t index = rcType.hash_code() & (kIndexSize - 1);
+            while ((mIndex[index].mpType != nullptr) && (*mIndex[index].mpType != rcType))
+            {
+                index = (index + 1) & (kIndexSize - 1);
+            }
+            return &mIndex[index];
+        }
+
+        /**
+         * @brief     Find the slot of an interface type (constant version)
+         * @param[in] rcType Interface type
+         * @return    Pointer to the slot of the interface if found, otherwise to an empty slot
+         */
+        const Slot* FindSlot(const std::type_info& rcType) const
+        {
+            return const_cast<FixedFactoryInjector *>(this)->FindSlot(rcType);
+        }
+
+    /*
+     * Members
+     */
+    private:
+        alignas(std::max_align_t) unsigned char mStorage[TStorageBytes];    /**< Factories storage    */
+        std::size_t                             mStorageUsed = 0;           /**< Used storage         */
+        std::size_t                             mCount = 0;                 /**< Registered factories */
+        Slot                                    mIndex[kIndexSize];         /**< Factories index      */
+};
+
+}   // namespace factory_injector
+
+#endif  // _FACTORY_INJECTOR_FIXED_FACTORY_INJECTOR_HPP_
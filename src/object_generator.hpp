@@ -0,0 +1,331 @@
+/**
+ * @copyright Copyright (c) 2020 Emanuele Bellocchia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file  object_generator.hpp
+ * @brief Declaration and definition of ObjectGenerator class
+ *
+ */
+
+#ifndef _FACTORY_INJECTOR_OBJECT_GENERATOR_HPP_
+#define _FACTORY_INJECTOR_OBJECT_GENERATOR_HPP_
+
+/*
+ * Includes
+ */
+
+// Standard
+#include <cstddef>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+// Project
+#include "factory_traits.hpp"
+
+/*
+ * Namespaces
+ */
+namespace factory_injector
+{
+
+/* Internal namespace, shall not be used */
+namespace generator_details
+{
+
+/**
+ * @brief  Helper struct for checking if a type is a tuple
+ * @tparam T Class type
+ */
+template<class T>
+struct is_tuple : std::false_type
+{};
+
+/**
+ * @brief  Helper struct for checking if a type is a tuple (specialization for tuples)
+ * @tparam TTypes Tuple types
+ */
+template<class ... TTypes>
+struct is_tuple<std::tuple<TTypes...>> : std::true_type
+{};
+
+}   // namespace generator_details
+
+/**
+ * @brief  Object generator class.
+ *         Lazy, single-pass range of objects created by a factory, one for each element of a range of arguments.
+ *         Each element of the arguments range is passed to the factory Create method, unpacked if it's a std::tuple.
+ *         Objects are created in chunks when the range is iterated, so that a consumer can process a chunk while
+ *         it's hot in cache and the creation loop is kept tight. The objects can be moved out of the range.
+ *         The factory is resolved once, when the generator is constructed, so it shall not be overwritten while
+ *         the generator is used.
+ * @tparam TFactory   Factory type
+ * @tparam TArgsRange Arguments range type, it's stored by reference if it's an l-value reference
+ * @tparam TCreator   Creator type, called with the factory and an element of the arguments range for creating an object
+ */
+template<class TFactory, class TArgsRange, class TCreator>
+class ObjectGenerator final
+{
+    /*
+     * Types
+     */
+    public:
+        /** Object pointer type definition */
+        using tObjectPtr = typename TFactory::tObjectPtr;
+
+    private:
+        /** Arguments iterator type definition */
+        using tArgsItr = decltype(std::begin(std::declval<TArgsRange&>()));
+        /** Arguments sentinel type definition */
+        using tArgsEnd = decltype(std::end(std::declval<TArgsRange&>()));
+
+    /*
+     * Classes
+     */
+    public:
+        /**
+         * @brief Input iterator for the generated objects
+         */
+        class Iterator
+        {
+            /*
+             * Types
+             */
+            public:
+                using iterator_category = std::input_iterator_tag;  /**< Iterator category   */
+                using value_type        = tObjectPtr;               /**< Value type          */
+                using difference_type   = std::ptrdiff_t;           /**< Difference type     */
+                using pointer           = tObjectPtr *;             /**< Pointer type        */
+                using reference         = tObjectPtr&;              /**< Reference type      */
+
+            /*
+             * Public methods
+             */
+            public:
+                /**
+                 * @brief     Constructor
+                 * @param[in] pGenerator Generator pointer, null for the end iterator
+                 */
+                explicit Iterator(ObjectGenerator *pGenerator = nullptr) :
+                    mpGenerator(pGenerator)
+                {}
+
+                /**
+                 * @brief  Dereference operator
+                 * @return Reference to the current object
+                 */
+                reference operator*(void) const
+                {
+                    return mpGenerator->Current();
+                }
+
+                /**
+                 * @brief  Arrow operator
+                 * @return Pointer to the current object
+                 */
+                pointer operator->(void) const
+                {
+                    return &mpGenerator->Current();
+                }
+
+                /**
+                 * @brief  Pre-increment operator
+                 * @return Iterator reference
+                 */
+                Iterator& operator++(void)
+                {
+                    mpGenerator->Next();
+                    return *this;
+                }
+
+                /**
+                 * @brief  Post-increment operator, the previous position cannot be used since the range is single-pass
+                 * @return void
+                 */
+                void operator++(int)
+                {
+                    ++*this;
+                }
+
+                /**
+                 * @brief     Equality operator
+                 * @param[in] rcOther Other iterator
+                 * @return    True if both iterators are at the end or point to the same generator, false otherwise
+                 */
+                bool operator==(const Iterator& rcOther) const
+                {
+                    return IsEnd() ? rcOther.IsEnd() : (mpGenerator == rcOther.mpGenerator);
+                }
+
+                /**
+                 * @brief     Inequality operator
+                 * @param[in] rcOther Other iterator
+                 * @return    True if iterators are different, false otherwise
+                 */
+                bool operator!=(const Iterator& rcOther) const
+                {
+                    return !(*this == rcOther);
+                }
+
+            /*
+             * Private methods
+             */
+            private:
+                /**
+                 * @brief  Get if the iterator is at the end
+                 * @return True if at the end, false otherwise
+                 */
+                bool IsEnd(void) const
+                {
+                    return (mpGenerator == nullptr) || mpGenerator->IsDone();
+                }
+
+            /*
+             * Members
+             */
+            private:
+                ObjectGenerator *mpGenerator;   /**< Generator pointer */
+        };
+
+    /*
+     * Public methods
+     */
+    public:
+        /**
+         * @brief     Constructor
+         * @param[in] rcFactory   Factory reference
+         * @param[in] rrArgsRange Arguments range
+         * @param[in] cChunkSize  Number of objects created at once
+         * @param[in] rcCreator   Object creator
+         */
+        template<class TRange>
+        ObjectGenerator(const TFactory& rcFactory,
+                        TRange&& rrArgsRange,
+                        const std::size_t cChunkSize,
+                        const TCreator& rcCreator) :
+            mrcFactory(rcFactory),
+            mCreator(rcCreator),
+            mArgsRange(std::forward<TRange>(rrArgsRange)),
+            mArgsItr(),
+            mArgsEnd(),
+            mChunkSize((cChunkSize == 0) ? 1 : cChunkSize),
+            mChunkPos(0),
+            mStarted(false)
+        {
+            mChunk.reserve(mChunkSize);
+        }
+
+        // The generator can be moved only before calling begin, since iterators point to it
+        ObjectGenerator(const ObjectGenerator&)            = delete;
+        ObjectGenerator& operator=(const ObjectGenerator&) = delete;
+        ObjectGenerator(ObjectGenerator&&)                 = default;
+
+        /**
+         * @brief  Get the iterator to the first object. Since the range is single-pass, it shall be called once.
+         * @return Iterator
+         */
+        Iterator begin(void)
+        {
+            if (!mStarted)
+            {
+                mStarted = true;
+                mArgsItr = std::begin(mArgsRange);
+                mArgsEnd = std::end(mArgsRange);
+                FillChunk();
+            }
+            return Iterator(this);
+        }
+
+        /**
+         * @brief  Get the end iterator
+         * @return Iterator
+         */
+        Iterator end(void)
+        {
+            return Iterator();
+        }
+
+    /*
+     * Private methods
+     */
+    private:
+        /**
+         * @brief  Get the current object
+         * @return Reference to the current object
+         */
+        tObjectPtr& Current(void)
+        {
+            return mChunk[mChunkPos];
+        }
+
+        /**
+         * @brief  Move to the next object, creating a new chunk if needed
+         * @return void
+         */
+        void Next(void)
+        {
+            if (++mChunkPos == mChunk.size())
+            {
+                FillChunk();
+            }
+        }
+
+        /**
+         * @brief  Get if all the objects have been generated and consumed
+         * @return True if done, false otherwise
+         */
+        bool IsDone(void) const
+        {
+            return mChunkPos == mChunk.size();
+        }
+
+        /**
+         * @brief  Create the next chunk of objects
+         * @return void
+         */
+        void FillChunk(void)
+        {
+            mChunk.clear();
+            mChunkPos = 0;
+            for (std::size_t i = 0; (i < mChunkSize) && (mArgsItr != mArgsEnd); i++, ++mArgsItr)
+            {
+                mChunk.push_back(mCreator(mrcFactory, *mArgsItr));
+            }
+        }
+
+    /*
+     * Members
+     */
+    private:
+        const TFactory&         mrcFactory;     /**< Factory reference            */
+        TCreator                mCreator;       /**< Object creator               */
+        TArgsRange              mArgsRange;     /**< Arguments range              */
+        tArgsItr                mArgsItr;       /**< Current arguments iterator   */
+        tArgsEnd                mArgsEnd;       /**< Arguments end                */
+        const std::size_t       mChunkSize;     /**< Chunk size                   */
+        std::vector<tObjectPtr> mChunk;         /**< Current chunk of objects     */
+        std::size_t             mChunkPos;      /**< Position in the current chunk */
+        bool                    mStarted;       /**< Started flag                 */
+};
+
+}   // namespace factory_injector
+
+#endif  // _FACTORY_INJECTOR_OBJECT_GENERATOR_HPP_
@@ -0,0 +1,386 @@
+/**
+ * @copyright Copyright (c) 2020 Emanuele Bellocchia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file  persistent_map.hpp
+ * @brief Declaration and definition of PersistentMap class, a persistent hash array mapped trie
+ *
+ */
+
+#ifndef _FACTORY_INJECTOR_PERSISTENT_MAP_HPP_
+#define _FACTORY_INJECTOR_PERSISTENT_MAP_HPP_
+
+/*
+ * Includes
+ */
+
+// Standard
+#include <algorithm>
+#include <bitset>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/*
+ * Namespaces
+ */
+namespace factory_injector
+{
+
+/* Internal namespace, shall not be used */
+namespace persistent_details
+{
+
+/**
+ * @brief  Persistent map, implemented as a hash array mapped trie.
+ *         Nodes are immutable and shared, so copying a map is O(1) and setting a value copies only the path
+ *         to it (at most one node per 5 bits of hash), leaving the other maps that share the nodes untouched.
+ *         Values are kept by shared pointer, so they are shared too.
+ *         The map shall not be modified while it's read by other threads, like standard containers.
+ * @tparam TKey   Key type
+ * @tparam TValue Value type
+ * @tparam THash  Hash type
+ */
+template<class TKey, class TValue, class THash = std::hash<TKey>>
+class PersistentMap
+{
+    /*
+     * Types
+     */
+    public:
+        /** Value pointer type definition */
+        using tValuePtr = std::shared_ptr<const TValue>;
+
+    private:
+        /**
+         * @brief Leaf, it contains the items with the same hash (usually one)
+         */
+        struct Leaf
+        {
+            std::size_t                                mHash;     /**< Hash  */
+            std::vector<std::pair<TKey, tValuePtr>>    mItems;    /**< Items */
+        };
+
+        struct Node;
+
+        /** Leaf pointer type definition */
+        using tLeafPtr = std::shared_ptr<const Leaf>;
+        /** Node pointer type definition */
+        using tNodePtr = std::shared_ptr<const Node>;
+
+        /**
+         * @brief Node slot, it points either to a child node or to a leaf
+         */
+        struct Slot
+        {
+            tNodePtr mChildPtr;   /**< Child node pointer */
+            tLeafPtr mLeafPtr;    /**< Leaf pointer       */
+        };
+
+        /**
+         * @brief Node, only the slots present in the bitmap are stored
+         */
+        struct Node
+        {
+            std::uint32_t     mBitmap = 0;  /**< Slots bitmap */
+            std::vector<Slot> mSlots;       /**< Slots        */
+        };
+
+    /*
+     * Constants
+     */
+    private:
+        /** Hash bits consumed by each level */
+        static constexpr unsigned kBitsPerLevel = 5;
+        /** Number of hash bits */
+        static constexpr unsigned kHashBits = sizeof(std::size_t) * CHAR_BIT;
+
+    /*
+     * Public methods
+     */
+    public:
+        /**
+         * @brief     Find a value
+         * @param[in] rcKey Key
+         * @return    Pointer to the value, nullptr if not found
+         */
+        const TValue* Find(const TKey& rcKey) const
+        {
+            const tValuePtr* p_value_ptr = FindPtr(rcKey);
+            return (p_value_ptr != nullptr) ? p_value_ptr->get() : nullptr;
+        }
+
+        /**
+         * @brief     Find a value pointer, for sharing the value
+         * @param[in] rcKey Key
+         * @return    Pointer to the value pointer, nullptr if not found
+         */
+        const tValuePtr* FindPtr(const TKey& rcKey) const
+        {
+            const std::size_t hash = THash()(rcKey);
+
+            const Node* p_node = mRootPtr.get();
+            for (unsigned shift = 0; p_node != nullptr; shift += kBitsPerLevel)
+            {
+                const std::uint32_t bit = GetBit(hash, shift);
+                if ((p_node->mBitmap & bit) == 0)
+                {
+                    return nullptr;
+                }
+
+                const Slot& slot = p_node->mSlots[GetSlotIndex(p_node->mBitmap, bit)];
+                if (slot.mLeafPtr)
+                {
+                    return (slot.mLeafPtr->mHash == hash) ? FindInLeaf(*slot.mLeafPtr, rcKey) : nullptr;
+                }
+                p_node = slot.mChildPtr.get();
+            }
+
+            return nullptr;
+        }
+
+        /**
+         * @brief     Set a value, by inserting or replacing it
+         * @param[in] rcKey     Key
+         * @param[in] valuePtr  Value pointer
+         * @return    True if inserted, false if replaced
+         */
+        bool Set(const TKey& rcKey,
+                 tValuePtr valuePtr)
+        {
+            bool inserted = false;
+            mRootPtr = Set(mRootPtr.get(), 0, THash()(rcKey), rcKey, std::move(valuePtr), inserted);
+            if (inserted)
+            {
+                mSize++;
+            }
+            return inserted;
+        }
+
+        /**
+         * @brief     Call a function for each item, in unspecified order
+         * @param[in] rcFunction Function, called with the key and the value
+         * @tparam    TFunction  Function type
+         * @return    void
+         */
+        template<class TFunction>
+        void ForEach(const TFunction& rcFunction) const
+        {
+            if (mRootPtr)
+            {
+                ForEach(*mRootPtr, rcFunction);
+            }
+        }
+
+        /**
+         * @brief  Get the number of items
+         * @return Number of items
+         */
+        std::size_t Size(void) const
+        {
+            return mSize;
+        }
+
+        /**
+         * @brief  Get the approximated memory used by an item, excluding the nodes shared with other items
+         * @return Bytes
+         */
+        static constexpr std::size_t GetItemSize(void)
+        {
+            return sizeof(Leaf) + sizeof(std::pair<TKey, tValuePtr>) + sizeof(Slot);
+        }
+
+    /*
+     * Private methods
+     */
+    private:
+        /**
+         * @brief     Get the bit of the hash at the specified level
+         * @param[in] cHash  Hash
+         * @param[in] cShift Level shift
+         * @return    Bit
+         */
+        static std::uint32_t GetBit(const std::size_t cHash,
+                                    const unsigned cShift)
+        {
+            return std::uint32_t(1) << ((cHash >> cShift) & ((1u << kBitsPerLevel) - 1));
+        }
+
+        /**
+         * @brief     Get the index of a slot in a node (i.e. number of slots before it)
+         * @param[in] cBitmap Node bitmap
+         * @param[in] cBit    Slot bit
+         * @return    Slot index
+         */
+        static std::size_t GetSlotIndex(const std::uint32_t cBitmap,
+                                        const std::uint32_t cBit)
+        {
+            return std::bitset<32>(cBitmap & (cBit - 1)).count();
+        }
+
+        /**
+         * @brief     Find a value in a leaf
+         * @param[in] rcLeaf Leaf
+         * @param[in] rcKey  Key
+         * @return    Pointer to the value pointer, nullptr if not found
+         */
+        static const tValuePtr* FindInLeaf(const Leaf& rcLeaf,
+                                           const TKey& rcKey)
+        {
+            for (const auto& item : rcLeaf.mItems)
+            {
+                if (item.first == rcKey)
+                {
+                    return &item.second;
+                }
+            }
+            return nullptr;
+        }
+
+        /**
+         * @brief     Create a node containing a single leaf
+         * @param[in] leafPtr Leaf pointer
+         * @param[in] cShift  Level shift
+         * @return    Node pointer
+         */
+        static std::shared_ptr<Node> MakeNode(tLeafPtr leafPtr,
+                                              const unsigned cShift)
+        {
+            auto node_ptr = std::make_shared<Node>();
+            node_ptr->mBitmap = GetBit(leafPtr->mHash, cShift);
+            node_ptr->mSlots.push_back(Slot{ nullptr, std::move(leafPtr) });
+            return node_ptr;
+        }
+
+        /**
+         * @brief     Set a value in a subtree, by copying the path to it
+         * @param[in] pNode     Subtree root node, it can be nullptr
+         * @param[in] cShift    Level shift
+         * @param[in] cHash     Key hash
+         * @param[in] rcKey     Key
+         * @param[in] valuePtr  Value pointer
+         * @param[out] rInserted Set to true if the value is inserted
+         * @return    New subtree root node
+         */
+        static tNodePtr Set(const Node* pNode,
+                            const unsigned cShift,
+                            const std::size_t cHash,
+                            const TKey& rcKey,
+                            tValuePtr valuePtr,
+                            bool& rInserted)
+        {
+            // New leaf
+            if (pNode == nullptr)
+            {
+                rInserted = true;
+                return MakeNode(std::make_shared<const Leaf>(Leaf{ cHash, { { rcKey, std::move(valuePtr) } } }), cShift);
+            }
+
+            auto node_ptr = std::make_shared<Node>(*pNode);
+            const std::uint32_t bit = GetBit(cHash, cShift);
+            const std::size_t index = GetSlotIndex(node_ptr->mBitmap, bit);
+
+            // Empty slot
+            if ((node_ptr->mBitmap & bit) == 0)
+            {
+                rInserted = true;
+                node_ptr->mBitmap |= bit;
+                node_ptr->mSlots.insert(std::begin(node_ptr->mSlots) + index,
+                                        Slot{ nullptr, std::make_shared<const Leaf>(Leaf{ cHash, { { rcKey, std::move(valuePtr) } } }) });
+                return node_ptr;
+            }
+
+            Slot& slot = node_ptr->mSlots[index];
+            if (!slot.mLeafPtr)
+            {
+                // Child node
+                slot.mChildPtr = Set(slot.mChildPtr.get(), cShift + kBitsPerLevel, cHash, rcKey, std::move(valuePtr), rInserted);
+            }
+            else if (slot.mLeafPtr->mHash == cHash)
+            {
+                // Same hash, replace or add the item
+                auto leaf_ptr = std::make_shared<Leaf>(*slot.mLeafPtr);
+                auto item_itr = std::find_if(std::begin(leaf_ptr->mItems), std::end(leaf_ptr->mItems),
+                                             [&rcKey](const std::pair<TKey, tValuePtr>& rcItem) { return rcItem.first == rcKey; });
+                if (item_itr != std::end(leaf_ptr->mItems))
+                {
+                    item_itr->second = std::move(valuePtr);
+                }
+                else
+                {
+                    rInserted = true;
+                    leaf_ptr->mItems.emplace_back(rcKey, std::move(valuePtr));
+                }
+                slot.mLeafPtr = std::move(leaf_ptr);
+            }
+            else
+            {
+                // Different hash, push the leaf one level down (hashes differ, so it terminates)
+                tNodePtr child_ptr = MakeNode(std::move(slot.mLeafPtr), cShift + kBitsPerLevel);
+                slot.mChildPtr = Set(child_ptr.get(), cShift + kBitsPerLevel, cHash, rcKey, std::move(valuePtr), rInserted);
+            }
+
+            return node_ptr;
+        }
+
+        /**
+         * @brief     Call a function for each item of a subtree
+         * @param[in] rcNode     Subtree root node
+         * @param[in] rcFunction Function, called with the key and the value
+         * @tparam    TFunction  Function type
+         * @return    void
+         */
+        template<class TFunction>
+        static void ForEach(const Node& rcNode,
+                            const TFunction& rcFunction)
+        {
+            for (const auto& slot : rcNode.mSlots)
+            {
+                if (slot.mLeafPtr)
+                {
+                    for (const auto& item : slot.mLeafPtr->mItems)
+                    {
+                        rcFunction(item.first, *item.second);
+                    }
+                }
+                else
+                {
+                    ForEach(*slot.mChildPtr, rcFunction);
+                }
+            }
+        }
+
+    /*
+     * Members
+     */
+    private:
+        tNodePtr    mRootPtr;     /**< Root node       */
+        std::size_t mSize = 0;    /**< Number of items */
+};
+
+}   // namespace persistent_details
+
+}   // namespace factory_injector
+
+#endif  // _FACTORY_INJECTOR_PERSISTENT_MAP_HPP_
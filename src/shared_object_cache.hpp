@@ -0,0 +1,537 @@
+/**
+ * @copyright Copyright (c) 2020 Emanuele Bellocchia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file  shared_object_cache.hpp
+ * @brief Declaration and definition of the cache for shared objects, keyed by constructor arguments
+ *
+ */
+
+#ifndef _FACTORY_INJECTOR_SHARED_OBJECT_CACHE_HPP_
+#define _FACTORY_INJECTOR_SHARED_OBJECT_CACHE_HPP_
+
+/*
+ * Includes
+ */
+
+// Standard
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <tuple>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+
+/*
+ * Namespaces
+ */
+namespace factory_injector
+{
+
+/* Internal namespace, shall not be used */
+namespace cache_details
+{
+
+/**
+ * @brief  Hash functor for tuples, it combines the std::hash of each element
+ * @tparam TTuple Tuple type
+ */
+template<class TTuple>
+struct TupleHash
+{
+    /**
+     * @brief     Compute hash
+     * @param[in] rcTuple Tuple
+     * @return    Hash value
+     */
+    std::size_t operator()(const TTuple& rcTuple) const
+    {
+        return Combine(rcTuple, std::make_index_sequence<std::tuple_size<TTuple>::value>());
+    }
+
+    /**
+     * @brief     Combine the hashes of the tuple elements
+     * @param[in] rcTuple  Tuple
+     * @tparam    TIndexes Tuple indexes
+     * @return    Hash value
+     */
+    template<std::size_t ... TIndexes>
+    static std::size_t Combine(const TTuple& rcTuple,
+                               std::index_sequence<TIndexes...>)
+    {
+        std::size_t seed = 0;
+        // Expand the hash combination for each element
+        static_cast<void>(std::initializer_list<int>{
+            (seed ^= std::hash<std::tuple_element_t<TIndexes, TTuple>>()(std::get<TIndexes>(rcTuple)) + 0x9e3779b9 + (seed << 6) + (seed >> 2), 0)...
+        });
+        return seed;
+    }
+};
+
+/**
+ * @brief  Key element of a cache, i.e. the type an argument is stored as in the key.
+ *         Arguments are stored decayed, so they shall be hashable by std::hash and equality comparable.
+ * @tparam T Decayed argument type
+ */
+template<class T>
+struct KeyElement
+{
+    /** Key element type definition */
+    using type = T;
+
+    /**
+     * @brief     Convert a key element back to the argument type
+     * @param[in] rcElement Key element
+     * @return    Argument
+     */
+    static const T& ToArg(const type& rcElement)
+    {
+        return rcElement;
+    }
+};
+
+/**
+ * @brief Key element of a cache (specialization for C strings).
+ *        C strings are stored as std::string, so that they're keyed by content rather than by pointer.
+ */
+template<>
+struct KeyElement<const char *>
+{
+    /** Key element type definition */
+    using type = std::string;
+
+    /**
+     * @brief     Convert a key element back to the argument type
+     * @param[in] rcElement Key element
+     * @return    Argument
+     */
+    static const char *ToArg(const type& rcElement)
+    {
+        return rcElement.c_str();
+    }
+};
+
+/**
+ * @brief Key element of a cache (specialization for non-constant C strings), they're passed to the factory as constant
+ */
+template<>
+struct KeyElement<char *> : public KeyElement<const char *>
+{};
+
+/**
+ * @brief  Helper alias for getting the key element type of an argument type
+ * @tparam T Argument type
+ */
+template<class T>
+using key_element_t = typename KeyElement<std::decay_t<T>>::type;
+
+/**
+ * @brief Abstract cache class, generic container for caches of different key types
+ */
+class AnyKeyCache
+{
+    /*
+     * Public methods
+     */
+    public:
+        /**
+         * @brief Destructor
+         */
+        virtual ~AnyKeyCache(void) = default;
+
+        /**
+         * @brief     Set the maximum number of cached objects, evicting objects if needed
+         * @param[in] cCapacity Capacity, 0 for unbounded
+         * @return    void
+         */
+        virtual void SetCapacity(const std::size_t cCapacity) = 0;
+};
+
+/**
+ * @brief  Cache of shared objects for a key type.
+ *         Lookups only take a shared lock, so they run concurrently, and objects are created outside the lock:
+ *         the first thread missing a key inserts a placeholder for it and creates the object, while the
+ *         other threads looking for the same key wait for it. So a slow creation only delays the threads
+ *         waiting for the same object, and a creator can use the cache again (for different keys).
+ *         When the capacity is exceeded, objects are evicted with the CLOCK algorithm, an approximation
+ *         of least recently used that only sets a flag on hits.
+ * @tparam TObject Object type
+ * @tparam TKey    Key type (tuple of arguments)
+ */
+template<class TObject, class TKey>
+class KeyCache final : public AnyKeyCache
+{
+    /*
+     * Types
+     */
+    public:
+        /** Shared object pointer type definition */
+        using tSharedPtr = std::shared_ptr<const TObject>;
+
+    private:
+        /** Shared object future type definition */
+        using tSharedFuture = std::shared_future<tSharedPtr>;
+
+        /**
+         * @brief Cache slot
+         */
+        struct Slot
+        {
+            /**
+             * @brief     Constructor
+             * @param[in] pcKey    Key, owned by the lookup container
+             * @param[in] rcObject Object future
+             * @param[in] cId      Slot identifier
+             */
+            Slot(const TKey *pcKey,
+                 const tSharedFuture& rcObject,
+                 const std::uint64_t cId) :
+                mpcKey(pcKey),
+                mObject(rcObject),
+                mId(cId),
+                mReferenced(true)
+            {}
+
+            const TKey         *mpcKey;         /**< Key                                   */
+            tSharedFuture       mObject;        /**< Object future                         */
+            const std::uint64_t mId;            /**< Slot identifier                       */
+            std::atomic<bool>   mReferenced;    /**< Referenced flag, cleared by the clock */
+        };
+
+        /** Slot list type definition, in clock order */
+        using tSlotList   = std::list<Slot>;
+        /** Lookup container type definition */
+        using tLookupCont = std::unordered_map<TKey, typename tSlotList::iterator, TupleHash<TKey>>;
+
+    /*
+     * Public methods
+     */
+    public:
+        /**
+         * @brief     Constructor
+         * @param[in] cCapacity Capacity, 0 for unbounded
+         */
+        explicit KeyCache(const std::size_t cCapacity) :
+            mCapacity(cCapacity),
+            mHand(std::end(mSlotList)),
+            mNextId(1)
+        {}
+
+        /**
+         * @brief     Get a cached object or create it.
+         *            If the creation throws, the exception is rethrown to all the threads waiting for the object
+         *            and the key is removed, so that the creation is retried by the next call.
+         * @param[in] rcKey     Key
+         * @param[in] rrCreator Object creator, called only if the object is not cached
+         * @tparam    TCreator  Creator type
+         * @return    Shared object pointer
+         */
+        template<class TCreator>
+        tSharedPtr GetOrCreate(const TKey& rcKey,
+                               TCreator&& rrCreator)
+        {
+            // Fast path: look for the object with a shared lock
+            tSharedFuture object;
+            {
+                std::shared_lock<std::shared_timed_mutex> lock(mMutex);
+
+                object = Find(rcKey);
+            }
+            if (object.valid())
+            {
+                return object.get();
+            }
+
+            // Slow path: insert a placeholder, unless another thread did it in the meantime
+            std::promise<tSharedPtr> promise;
+            std::uint64_t slot_id = 0;
+            {
+                std::lock_guard<std::shared_timed_mutex> lock(mMutex);
+
+                object = Find(rcKey);
+                if (!object.valid())
+                {
+                    object  = promise.get_future().share();
+                    slot_id = Insert(rcKey, object);
+                }
+            }
+            // If another thread is creating the object, wait for it outside the lock
+            if (slot_id == 0)
+            {
+                return object.get();
+            }
+
+            // Create the object outside the lock
+            try
+            {
+                promise.set_value(rrCreator(rcKey));
+            }
+            catch (...)
+            {
+                promise.set_exception(std::current_exception());
+                Erase(rcKey, slot_id);
+                throw;
+            }
+
+            return object.get();
+        }
+
+        /**
+         * @brief     Set the maximum number of cached objects, evicting objects if needed
+         * @param[in] cCapacity Capacity, 0 for unbounded
+         * @return    void
+         */
+        void SetCapacity(const std::size_t cCapacity) override
+        {
+            std::lock_guard<std::shared_timed_mutex> lock(mMutex);
+
+            mCapacity = cCapacity;
+            Evict();
+        }
+
+    /*
+     * Private methods
+     */
+    private:
+        /**
+         * @brief     Find an object and mark it as referenced. The lock shall be held (shared or exclusive).
+         * @param[in] rcKey Key
+         * @return    Object future, not valid if not found
+         */
+        tSharedFuture Find(const TKey& rcKey) const
+        {
+            auto lookup_itr = mLookupCont.find(rcKey);
+            if (lookup_itr == std::end(mLookupCont))
+            {
+                return tSharedFuture();
+            }
+
+            lookup_itr->second->mReferenced.store(true, std::memory_order_relaxed);
+            return lookup_itr->second->mObject;
+        }
+
+        /**
+         * @brief     Insert an object, evicting objects if needed. The exclusive lock shall be held.
+         * @param[in] rcKey    Key
+         * @param[in] rcObject Object future
+         * @return    Slot identifier
+         */
+        std::uint64_t Insert(const TKey& rcKey,
+                             const tSharedFuture& rcObject)
+        {
+            const std::uint64_t cId = mNextId++;
+
+            // Insert behind the hand, so that the slot is the last one visited by the clock
+            auto lookup_itr = mLookupCont.emplace(rcKey, std::end(mSlotList)).first;
+            lookup_itr->second = mSlotList.emplace(mHand, &lookup_itr->first, rcObject, cId);
+            Evict();
+
+            return cId;
+        }
+
+        /**
+         * @brief     Erase an object, only if it's still in the specified slot
+         * @param[in] rcKey Key
+         * @param[in] cId   Slot identifier
+         * @return    void
+         */
+        void Erase(const TKey& rcKey,
+                   const std::uint64_t cId)
+        {
+            std::lock_guard<std::shared_timed_mutex> lock(mMutex);
+
+            auto lookup_itr = mLookupCont.find(rcKey);
+            if ((lookup_itr != std::end(mLookupCont)) && (lookup_itr->second->mId == cId))
+            {
+                EraseSlot(lookup_itr->second);
+            }
+        }
+
+        /**
+         * @brief     Erase a slot, moving the hand if it points to it. The exclusive lock shall be held.
+         * @param[in] slotItr Slot iterator
+         * @return    Iterator to the next slot
+         */
+        typename tSlotList::iterator EraseSlot(typename tSlotList::iterator slotItr)
+        {
+            // The key is owned by the lookup container, so the slot is erased first
+            const bool  cIsHand = (mHand == slotItr);
+            const TKey *pcKey   = slotItr->mpcKey;
+            auto next_itr = mSlotList.erase(slotItr);
+            if (cIsHand)
+            {
+                mHand = next_itr;
+            }
+            mLookupCont.erase(*pcKey);
+
+            return next_itr;
+        }
+
+        /**
+         * @brief  Evict objects exceeding the capacity with the CLOCK algorithm: the hand clears the referenced flag
+         *         of the slots it visits and evicts the first slot that was not referenced.
+         *         The exclusive lock shall be held.
+         * @return void
+         */
+        void Evict(void)
+        {
+            while ((mCapacity != 0) && (mSlotList.size() > mCapacity))
+            {
+                if (mHand == std::end(mSlotList))
+                {
+                    mHand = std::begin(mSlotList);
+                }
+
+                if (mHand->mReferenced.exchange(false, std::memory_order_relaxed))
+                {
+                    ++mHand;
+                }
+                else
+                {
+                    mHand = EraseSlot(mHand);
+                }
+            }
+        }
+
+    /*
+     * Members
+     */
+    private:
+        mutable std::shared_timed_mutex mMutex;         /**< Mutex                               */
+        std::size_t                     mCapacity;      /**< Capacity                            */
+        tSlotList                       mSlotList;      /**< Slot list                           */
+        tLookupCont                     mLookupCont;    /**< Lookup container                    */
+        typename tSlotList::iterator    mHand;          /**< Clock hand, next slot to visit      */
+        std::uint64_t                   mNextId;        /**< Next slot identifier, 0 is not used */
+};
+
+}   // namespace cache_details
+
+/**
+ * @brief Shared object cache class.
+ *        Thread-safe cache of the shared objects created by a factory, keyed by the arguments they were
+ *        created with. There is a separate cache for each list of argument types, see KeyCache.
+ */
+class SharedObjectCache final
+{
+    /*
+     * Types
+     */
+    private:
+        /** Key cache pointer type definition, it's shared so that it can be used outside the lock */
+        using tKeyCachePtr  = std::shared_ptr<cache_details::AnyKeyCache>;
+        /** Key cache container type definition */
+        using tKeyCacheCont = std::unordered_map<std::type_index, tKeyCachePtr>;
+
+    /*
+     * Public methods
+     */
+    public:
+        /**
+         * @brief     Get a cached object or create it
+         * @param[in] rcKey     Key
+         * @param[in] rrCreator Object creator, called only if the object is not cached
+         * @tparam    TObject   Object type
+         * @tparam    TKey      Key type (tuple of arguments)
+         * @tparam    TCreator  Creator type
+         * @return    Shared object pointer
+         */
+        template<class TObject, class TKey, class TCreator>
+        std::shared_ptr<const TObject> GetOrCreate(const TKey& rcKey,
+                                                   TCreator&& rrCreator)
+        {
+            // Helper type for shortening
+            using tKeyCache = cache_details::KeyCache<TObject, TKey>;
+
+            const std::type_index cKeyCacheIdx(typeid(tKeyCache));
+
+            tKeyCachePtr key_cache_ptr;
+            {
+                std::shared_lock<std::shared_timed_mutex> lock(mMutex);
+
+                auto key_cache_itr = mKeyCacheCont.find(cKeyCacheIdx);
+                if (key_cache_itr != std::end(mKeyCacheCont))
+                {
+                    key_cache_ptr = key_cache_itr->second;
+                }
+            }
+            if (!key_cache_ptr)
+            {
+                std::lock_guard<std::shared_timed_mutex> lock(mMutex);
+
+                auto& new_key_cache_ptr = mKeyCacheCont[cKeyCacheIdx];
+                if (!new_key_cache_ptr)
+                {
+                    new_key_cache_ptr = std::make_shared<tKeyCache>(mCapacity);
+                }
+                key_cache_ptr = new_key_cache_ptr;
+            }
+
+            return static_cast<tKeyCache&>(*key_cache_ptr).GetOrCreate(rcKey, std::forward<TCreator>(rrCreator));
+        }
+
+        /**
+         * @brief     Set the maximum number of cached objects for each list of argument types
+         * @param[in] cCapacity Capacity, 0 for unbounded
+         * @return    void
+         */
+        void SetCapacity(const std::size_t cCapacity)
+        {
+            std::lock_guard<std::shared_timed_mutex> lock(mMutex);
+
+            mCapacity = cCapacity;
+            for (auto& key_cache : mKeyCacheCont)
+            {
+                key_cache.second->SetCapacity(cCapacity);
+            }
+        }
+
+        /**
+         * @brief  Get the maximum number of cached objects for each list of argument types
+         * @return Capacity, 0 for unbounded
+         */
+        std::size_t GetCapacity(void) const
+        {
+            std::shared_lock<std::shared_timed_mutex> lock(mMutex);
+
+            return mCapacity;
+        }
+
+    /*
+     * Members
+     */
+    private:
+        mutable std::shared_timed_mutex mMutex;         /**< Mutex               */
+        std::size_t                     mCapacity = 0;  /**< Capacity            */
+        tKeyCacheCont                   mKeyCacheCont;  /**< Key cache container */
+};
+
+}   // namespace factory_injector
+
+#endif  // _FACTORY_INJECTOR_SHARED_OBJECT_CACHE_HPP_
@@ -0,0 +1,177 @@
+/**
+ * @copyright Copyright (c) 2020 Emanuele Bellocchia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file  static_registration.hpp
+ * @brief Macros and types for the link-time static registration of factories
+ *
+ */
+
+#ifndef _FACTORY_INJECTOR_STATIC_REGISTRATION_HPP_
+#define _FACTORY_INJECTOR_STATIC_REGISTRATION_HPP_
+
+/*
+ * Includes
+ */
+
+// Standard
+#include <cstddef>
+
+/*
+ * Macros
+ */
+
+#if defined(__GNUC__) && defined(__ELF__)
+/** Static registration is supported */
+#define FACTORY_INJECTOR_STATIC_REGISTRATION_SUPPORTED     1
+#else
+/** Static registration is not supported */
+#define FACTORY_INJECTOR_STATIC_REGISTRATION_SUPPORTED     0
+#endif
+
+#if defined(__has_attribute)
+#if __has_attribute(retain)
+/** Attributes of the descriptors, retain keeps them when linking with --gc-sections */
+#define FACTORY_INJECTOR_STATIC_REGISTRATION_ATTRS      used, retain, section("factory_injector_reg")
+#endif
+#endif
+#if !defined(FACTORY_INJECTOR_STATIC_REGISTRATION_ATTRS)
+/** Attributes of the descriptors (retain is not supported, see FACTORY_INJECTOR_STATIC_REGISTER about --gc-sections) */
+#define FACTORY_INJECTOR_STATIC_REGISTRATION_ATTRS      used, section("factory_injector_reg")
+#endif
+
+/** Helper macros for concatenating tokens */
+#define FACTORY_INJECTOR_CONCAT_IMPL(a, b)    a##b
+#define FACTORY_INJECTOR_CONCAT(a, b)         FACTORY_INJECTOR_CONCAT_IMPL(a, b)
+
+#if FACTORY_INJECTOR_STATIC_REGISTRATION_SUPPORTED
+
+/**
+ * Register a factory statically, it shall be used at namespace scope, e.g.:
+ *     FACTORY_INJECTOR_STATIC_REGISTER(MyRealObjFactory);
+ * No code is run at startup: a constant descriptor is placed in a dedicated linker section and the factory is registered
+ * only when FactoryInjector::RegisterAllStatic is called.
+ * When linking with --gc-sections, the descriptors are kept by the retain attribute (GCC 11+/Clang 13+ with binutils 2.36+).
+ * With older compilers the section is kept only because it's referenced by its __start/__stop symbols, which is the default
+ * of GNU ld but not of lld 13+ (-z nostart-stop-gc is needed); a linker script shall KEEP(*(factory_injector_reg)).
+ */
+#define FACTORY_INJECTOR_STATIC_REGISTER(...)                                                                           \
+    __attribute__((FACTORY_INJECTOR_STATIC_REGISTRATION_ATTRS))                                                         \
+    static const ::factory_injector::static_reg_details::StaticRegistration                                             \
+        FACTORY_INJECTOR_CONCAT(factory_injector_static_reg_, __COUNTER__) =                                            \
+    {                                                                                                                   \
+        &::factory_injector::static_reg_details::RegisterFactory<__VA_ARGS__>                                           \
+    }
+
+#else
+
+/** Register a factory statically (not supported for this compiler/platform) */
+#define FACTORY_INJECTOR_STATIC_REGISTER(...)                                                                           \
+    static_assert(sizeof(__VA_ARGS__) == 0, "Static registration is only supported by GCC/Clang on ELF platforms")
+
+#endif
+
+/*
+ * Namespaces
+ */
+namespace factory_injector
+{
+
+/*
+ * Forward declarations
+ */
+class FactoryInjector;
+
+/* Internal namespace, shall not be used */
+namespace static_reg_details
+{
+
+/**
+ * @brief Static registration descriptor
+ */
+struct StaticRegistration
+{
+    void (*mpRegister)(FactoryInjector&);   /**< Registration function */
+};
+
+/**
+ * @brief     Register a factory (TInjector is only used to defer the lookup of the injector methods)
+ * @param[in] rFactoryInjector Factory injector
+ * @tparam    TFactory  Factory type
+ * @tparam    TInjector Injector type
+ * @return    void
+ */
+template<class TFactory, class TInjector = FactoryInjector>
+void RegisterFactory(TInjector& rFactoryInjector)
+{
+    rFactoryInjector.template RegisterFactory<TFactory>();
+}
+
+}   // namespace static_reg_details
+
+}   // namespace factory_injector
+
+#if FACTORY_INJECTOR_STATIC_REGISTRATION_SUPPORTED
+/* Section boundaries, defined by the linker only if the section is not empty */
+extern "C"
+{
+    extern const ::factory_injector::static_reg_details::StaticRegistration __start_factory_injector_reg[] __attribute__((weak));
+    extern const ::factory_injector::static_reg_details::StaticRegistration __stop_factory_injector_reg[] __attribute__((weak));
+}
+#endif
+
+namespace factory_injector
+{
+
+/* Internal namespace, shall not be used */
+namespace static_reg_details
+{
+
+/**
+ * @brief  Get the first static registration descriptor
+ * @return Pointer to the first descriptor (nullptr if there are no descriptors)
+ */
+inline const StaticRegistration* GetBegin(void)
+{
+#if FACTORY_INJECTOR_STATIC_REGISTRATION_SUPPORTED
+    return __start_factory_injector_reg;
+#else
+    return nullptr;
+#endif
+}
+
+/**
+ * @brief  Get the end of the static registration descriptors
+ * @return Pointer past the last descriptor (nullptr if there are no descriptors)
+ */
+inline const StaticRegistration* GetEnd(void)
+{
+#if FACTORY_INJECTOR_STATIC_REGISTRATION_SUPPORTED
+    return __stop_factory_injector_reg;
+#else
+    return nullptr;
+#endif
+}
+
+}   // namespace static_reg_details
+
+}   // namespace factory_injector
+
+#endif  // _FACTORY_INJECTOR_STATIC_REGISTRATION_HPP_
@@ -0,0 +1,355 @@
+/**
+ * @copyright Copyright (c) 2020 Emanuele Bellocchia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file  thread_executor.hpp
+ * @brief Declaration and definition of ThreadExecutor class
+ *
+ */
+
+#ifndef _FACTORY_INJECTOR_THREAD_EXECUTOR_HPP_
+#define _FACTORY_INJECTOR_THREAD_EXECUTOR_HPP_
+
+/*
+ * Includes
+ */
+
+// Standard
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+// Project
+#include "not_copyable_movable.hpp"
+
+/*
+ * Namespaces
+ */
+namespace factory_injector
+{
+
+/* Internal namespace, shall not be used */
+namespace executor_details
+{
+
+/**
+ * @brief Thread pool class.
+ *        Pool of persistent worker threads, shared by all the thread executors of the process. Workers are created
+ *        on demand and they're kept until the process exits, so the cost of creating threads is paid only once.
+ *        A thread waiting for its tasks runs the queued tasks too, so tasks are completed even if the pool cannot
+ *        create all the requested workers, and tasks can run other tasks (nested parallelism) without deadlocking.
+ *        The pool never shrinks: it keeps as many workers as the largest batch has requested, and idle ones just wait
+ *        on the condition variable.
+ *        Jobs are queued in a single queue protected by a single mutex, that is locked a few times per task: it's meant
+ *        for coarse tasks (e.g. a chunk of objects per thread, as CreateObjectsParallel does), while fine-grained
+ *        tasks would contend on it.
+ */
+class ThreadPool final : public NotCopyMovable
+{
+    /*
+     * Types
+     */
+    private:
+        /**
+         * @brief Batch of tasks, it lives on the stack of the thread that runs it
+         */
+        struct Batch
+        {
+            const void   *mpcTask;                      /**< Task                              */
+            void        (*mpInvoker)(const void *,
+                                     std::size_t);      /**< Task invoker                      */
+            std::size_t   mPendingCount;                /**< Number of tasks not finished yet  */
+        };
+
+        /**
+         * @brief Queued task
+         */
+        struct Job
+        {
+            Batch       *mpBatch;       /**< Batch of the task */
+            std::size_t  mTaskIdx;      /**< Task index        */
+        };
+
+    /*
+     * Public methods
+     */
+    public:
+        /**
+         * @brief Constructor
+         */
+        ThreadPool(void) = default;
+
+        /**
+         * @brief Destructor, it stops and joins the workers
+         */
+        ~ThreadPool(void)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mStop = true;
+            }
+            mJobCv.notify_all();
+            for (auto& worker : mWorkers)
+            {
+                worker.join();
+            }
+        }
+
+        /**
+         * @brief  Get the pool of the process
+         * @return Thread pool reference
+         */
+        static ThreadPool& Get(void)
+        {
+            static ThreadPool pool;
+
+            return pool;
+        }
+
+        /**
+         * @brief     Run the tasks, the first one on the calling thread and the others on the workers, and wait for them.
+         *            The pool is grown to have a worker for each task (but the first one) if possible.
+         *            Tasks shall not throw.
+         * @param[in] cTaskCount Number of tasks
+         * @param[in] rcTask     Task to be run, it's called with the task index
+         * @tparam    TTask      Task type
+         * @return    void
+         */
+        template<class TTask>
+        void Run(const std::size_t cTaskCount,
+                 const TTask& rcTask)
+        {
+            if (cTaskCount == 0)
+            {
+                return;
+            }
+
+            Batch batch{ &rcTask,
+                         [](const void *pcTask, const std::size_t cTaskIdx) { (*static_cast<const TTask *>(pcTask))(cTaskIdx); },
+                         0 };
+
+            // Queue all the tasks but the first one. If queuing fails, the queued tasks are still waited for.
+            std::exception_ptr queue_ex;
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+
+                GrowWorkers(cTaskCount - 1);
+                try
+                {
+                    for (std::size_t task_idx = 1; task_idx < cTaskCount; task_idx++)
+                    {
+                        mJobs.push_back(Job{ &batch, task_idx });
+                        batch.mPendingCount++;
+                    }
+                }
+                catch (...)
+                {
+                    queue_ex = std::current_exception();
+                }
+            }
+            mJobCv.notify_all();
+
+            // Run the first task, then help running the queued tasks until the batch is finished
+            rcTask(0);
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                while (batch.mPendingCount != 0)
+                {
+                    if (!mJobs.empty())
+                    {
+                        RunJob(lock);
+                    }
+                    else
+                    {
+                        mDoneCv.wait(lock);
+                    }
+                }
+            }
+
+            if (queue_ex)
+            {
+                std::rethrow_exception(queue_ex);
+            }
+        }
+
+    /*
+     * Private methods
+     */
+    private:
+        /**
+         * @brief     Grow the workers to the specified number, if possible. The lock shall be held.
+         *            If the storage cannot be allocated or a thread cannot be created, the workers created so far are
+         *            kept and the error is ignored, since waiting threads run the tasks too.
+         * @param[in] cWorkerCount Number of workers
+         * @return    void
+         */
+        void GrowWorkers(const std::size_t cWorkerCount)
+        {
+            try
+            {
+                // Reserve first, so that a thread is never created without a slot for joining it
+                mWorkers.reserve(cWorkerCount);
+                while (mWorkers.size() < cWorkerCount)
+                {
+                    mWorkers.emplace_back([this]() { WorkerLoop(); });
+                }
+            }
+            catch (...)
+            {
+                // Keep the workers created so far
+            }
+        }
+
+        /**
+         * @brief     Run the first queued job. The lock shall be held and it's released while running the job.
+         * @param[in] rLock Lock
+         * @return    void
+         */
+        void RunJob(std::unique_lock<std::mutex>& rLock)
+        {
+            Job job = mJobs.front();
+            mJobs.pop_front();
+
+            rLock.unlock();
+            job.mpBatch->mpInvoker(job.mpBatch->mpcTask, job.mTaskIdx);
+            rLock.lock();
+
+            if (--job.mpBatch->mPendingCount == 0)
+            {
+                mDoneCv.notify_all();
+            }
+        }
+
+        /**
+         * @brief  Worker loop, it runs the queued jobs until the pool is stopped
+         * @return void
+         */
+        void WorkerLoop(void)
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            while (true)
+            {
+                mJobCv.wait(lock, [this]() { return mStop || !mJobs.empty(); });
+                if (mJobs.empty())
+                {
+                    return;
+                }
+                RunJob(lock);
+            }
+        }
+
+    /*
+     * Members
+     */
+    private:
+        std::mutex               mMutex;            /**< Mutex                                   */
+        std::condition_variable  mJobCv;            /**< Condition for queued jobs               */
+        std::condition_variable  mDoneCv;           /**< Condition for finished batches          */
+        std::deque<Job>          mJobs;             /**< Queued jobs                             */
+        std::vector<std::thread> mWorkers;          /**< Workers                                 */
+        bool                     mStop = false;     /**< Stop flag                               */
+};
+
+}   // namespace executor_details
+
+/**
+ * @brief Thread executor class.
+ *        Executor that runs tasks on a pool of persistent threads and waits for them, used by FactoryInjector::CreateObjectsParallel.
+ *        The pool is shared by all the executors of the process, so constructing an executor is cheap and
+ *        threads are created only once. Since threads are reused, per-thread data (e.g. allocator arenas and
+ *        per-thread factories) is reused too.
+ *        Any other executor can be used instead, as long as it provides the same GetThreadCount and call operator.
+ */
+class ThreadExecutor final
+{
+    /*
+     * Public methods
+     */
+    public:
+        /**
+         * @brief     Constructor
+         * @param[in] cThreadCount Number of threads, 0 for the number of hardware threads
+         */
+        explicit ThreadExecutor(const std::size_t cThreadCount = 0) :
+            mThreadCount((cThreadCount != 0) ? cThreadCount : std::max<std::size_t>(1, std::thread::hardware_concurrency()))
+        {}
+
+        /**
+         * @brief  Get the number of threads
+         * @return Number of threads
+         */
+        std::size_t GetThreadCount(void) const
+        {
+            return mThreadCount;
+        }
+
+        /**
+         * @brief     Run the tasks, each one on a different thread (the first one on the calling thread), and wait for them.
+         *            If some tasks throw, the first exception is rethrown after all of them have finished.
+         * @param[in] cTaskCount Number of tasks
+         * @param[in] rcTask     Task to be run, it's called with the task index
+         * @tparam    TTask      Task type
+         * @return    void
+         */
+        template<class TTask>
+        void operator()(const std::size_t cTaskCount,
+                        const TTask& rcTask) const
+        {
+            std::exception_ptr first_ex;
+            std::mutex ex_mutex;
+
+            auto run_task = [&](const std::size_t cTaskIdx)
+            {
+                try
+                {
+                    rcTask(cTaskIdx);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(ex_mutex);
+                    if (!first_ex)
+                    {
+                        first_ex = std::current_exception();
+                    }
+                }
+            };
+
+            executor_details::ThreadPool::Get().Run(cTaskCount, run_task);
+
+            if (first_ex)
+            {
+                std::rethrow_exception(first_ex);
+            }
+        }
+
+    /*
+     * Members
+     */
+    private:
+        std::size_t mThreadCount;   /**< Number of threads */
+};
+
+}   // namespace factory_injector
+
+#endif  // _FACTORY_INJECTOR_THREAD_EXECUTOR_HPP_
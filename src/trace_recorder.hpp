@@ -0,0 +1,505 @@
+/**
+ * @copyright Copyright (c) 2020 Emanuele Bellocchia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * @file  trace_recorder.hpp
+ * @brief Declaration and definition of classes for recording factory injector events to a memory-mapped ring file
+ *        and reading them back (e.g. for replaying them offline)
+ *
+ */
+
+#ifndef _FACTORY_INJECTOR_TRACE_RECORDER_HPP_
+#define _FACTORY_INJECTOR_TRACE_RECORDER_HPP_
+
+/*
+ * Includes
+ */
+
+// Standard
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+#include <vector>
+// System
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+// Project
+#include "not_copyable_movable.hpp"
+
+/*
+ * Namespaces
+ */
+namespace factory_injector
+{
+
+/**
+ * @brief Trace event type
+ */
+enum class TraceEventType : std::uint8_t
+{
+    GetFactory      = 0,    /**< GetFactory call                            */
+    CreateObject    = 1,    /**< Factory Create call (CreateObject, CreateObjectsParallel, Generate) */
+    OverwriteFactory = 2,   /**< Factory registered or overwritten          */
+};
+
+/**
+ * @brief Trace event, as stored in the trace file
+ */
+struct TraceEvent
+{
+    std::uint64_t  mSequence;       /**< Sequence number plus one, 0 if the slot was never written */
+    std::uint64_t  mTimestampNs;    /**< Start time, in nanoseconds from the recorder creation     */
+    std::uint64_t  mTypeId;         /**< Interface type id (FNV-1a hash of the type name)          */
+    std::uint32_t  mDurationNs;     /**< Duration, in nanoseconds (saturated)                      */
+    std::uint16_t  mThreadId;       /**< Thread id, in order of first recorded event               */
+    std::uint16_t  mArgBytes;       /**< Size of the arguments, in bytes (saturated)               */
+    TraceEventType mType;           /**< Event type                                                */
+    std::uint8_t   mReserved[7];    /**< Reserved                                                  */
+};
+
+/**
+ * @brief Custom exception in case a trace file cannot be created or read
+ */
+class TraceFileEx : public std::runtime_error
+{
+    /*
+     * Public methods
+     */
+    public:
+        /**
+         * @brief     Constructor
+         * @param[in] rcPath   Trace file path
+         * @param[in] rcReason Failure reason
+         */
+        TraceFileEx(const std::string& rcPath,
+                    const std::string& rcReason) :
+            std::runtime_error("Unable to use trace file " + rcPath + ": " + rcReason)
+        {}
+};
+
+/* Internal namespace, shall not be used */
+namespace trace_details
+{
+
+/** Trace file magic */
+constexpr char kMagic[8] = { 'F', 'I', 'T', 'R', 'A', 'C', 'E', '2' };
+/** Number of entries of the name table */
+constexpr std::uint32_t kNameCount = 256;
+/** Maximum length of a name in the name table, longer names are truncated */
+constexpr std::size_t kNameLength = 111;
+/** Sequence of an event slot being written */
+constexpr std::uint64_t kBusySequence = ~std::uint64_t(0);
+
+/**
+ * @brief Trace file header, followed by the name table and the events ring
+ */
+struct FileHeader
+{
+    char                       mMagic[8];   /**< Magic                          */
+    std::uint32_t              mEventSize;  /**< Event size                     */
+    std::uint32_t              mNameCount;  /**< Name table entries             */
+    std::uint64_t              mCapacity;   /**< Ring capacity, in events       */
+    std::atomic<std::uint64_t> mCursor;     /**< Number of events ever recorded */
+};
+
+/**
+ * @brief Name table entry, it maps an interface type id to its name
+ */
+struct NameEntry
+{
+    std::atomic<std::uint64_t> mTypeId;                 /**< Interface type id, 0 if the entry is free */
+    std::atomic<std::uint8_t>  mReady;                  /**< Set when the name is written              */
+    char                       mName[kNameLength + 1];  /**< Interface name                            */
+};
+
+/**
+ * @brief Event slot, as written by the recorder. The sequence is written last with release semantics,
+ *        so it can be used for checking if the event is complete.
+ */
+struct EventSlot
+{
+    std::atomic<std::uint64_t> mSequence;       /**< Sequence number plus one, 0 if never written, kBusySequence while written */
+    std::uint64_t              mTimestampNs;    /**< Start time                 */
+    std::uint64_t              mTypeId;         /**< Interface type id          */
+    std::uint32_t              mDurationNs;     /**< Duration                   */
+    std::uint16_t              mThreadId;       /**< Thread id                  */
+    std::uint16_t              mArgBytes;       /**< Size of the arguments      */
+    TraceEventType             mType;           /**< Event type                 */
+    std::uint8_t               mReserved[7];    /**< Reserved                   */
+};
+
+static_assert(sizeof(TraceEvent) == 40, "Unexpected trace event size");
+static_assert(sizeof(EventSlot) == sizeof(TraceEvent), "The event slot shall have the same layout of the trace event");
+static_assert(sizeof(NameEntry) == 128, "Unexpected name entry size");
+
+/**
+ * @brief     Hash a type name with FNV-1a, so that type ids are the same across builds and runs
+ * @param[in] pcName Type name
+ * @return    Type id, never 0
+ */
+inline std::uint64_t HashTypeName(const char* pcName)
+{
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (; *pcName != '\0'; pcName++)
+    {
+        hash ^= static_cast<unsigned char>(*pcName);
+        hash *= 1099511628211ULL;
+    }
+    return (hash != 0) ? hash : 1;
+}
+
+/**
+ * @brief  Get the type id of an interface, computed only once
+ * @tparam TInterface Interface type
+ * @return Type id
+ */
+template<class TInterface>
+std::uint64_t GetTypeId(void)
+{
+    static const std::uint64_t type_id = HashTypeName(typeid(TInterface).name());
+
+    return type_id;
+}
+
+/**
+ * @brief     Saturate a value to the maximum of a type
+ * @param[in] cValue Value
+ * @tparam    T      Result type
+ * @return    Saturated value
+ */
+template<class T>
+T Saturate(const std::uint64_t cValue)
+{
+    return static_cast<T>(std::min<std::uint64_t>(cValue, static_cast<T>(~T(0))));
+}
+
+/**
+ * @brief  Get the id of the current thread, in order of first call
+ * @return Thread id
+ */
+inline std::uint16_t GetThreadId(void)
+{
+    static std::atomic<std::uint32_t> next_thread_id{0};
+    thread_local const std::uint16_t thread_id = Saturate<std::uint16_t>(next_thread_id.fetch_add(1, std::memory_order_relaxed));
+
+    return thread_id;
+}
+
+}   // namespace trace_details
+
+/**
+ * @brief Trace recorder class.
+ *        It records events to a ring of fixed-size events in a memory-mapped file, so recording is a few stores
+ *        and the events are persisted by the operating system, also if the process crashes. When the ring is full,
+ *        the oldest events are overwritten. It's thread-safe.
+ *        Each event slot is marked as busy while it's written and its sequence is stored last, so events interrupted by
+ *        a crash are skipped by the reader. If the ring wraps while a slot is written, the other event for that slot is dropped.
+ *        The file also contains a table with the names of the recorded interfaces, whose ids are stable across builds.
+ */
+class TraceRecorder : public NotCopyMovable
+{
+    /*
+     * Public methods
+     */
+    public:
+        /**
+         * @brief     Constructor, it creates (or truncates) the trace file.
+         *            TraceFileEx is thrown if the file cannot be created.
+         * @param[in] rcPath    Trace file path
+         * @param[in] cCapacity Ring capacity, in events
+         */
+        TraceRecorder(const std::string& rcPath,
+                      const std::size_t cCapacity) :
+            mStartTime(std::chrono::steady_clock::now()),
+            mCapacity(std::max<std::size_t>(cCapacity, 1)),
+            mSize(sizeof(trace_details::FileHeader) + trace_details::kNameCount * sizeof(trace_details::NameEntry) + mCapacity * sizeof(TraceEvent))
+        {
+            const int fd = ::open(rcPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0)
+            {
+                throw TraceFileEx(rcPath, std::strerror(errno));
+            }
+
+            void *p_map = MAP_FAILED;
+            if (::ftruncate(fd, static_cast<off_t>(mSize)) == 0)
+            {
+                p_map = ::mmap(nullptr, mSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            }
+            const int error = errno;
+            ::close(fd);
+            if (p_map == MAP_FAILED)
+            {
+                throw TraceFileEx(rcPath, std::strerror(error));
+            }
+
+            // The file is zero-filled, so only the header shall be initialized
+            mpHeader = ::new (p_map) trace_details::FileHeader();
+            std::memcpy(mpHeader->mMagic, trace_details::kMagic, sizeof(trace_details::kMagic));
+            mpHeader->mEventSize = sizeof(TraceEvent);
+            mpHeader->mNameCount = trace_details::kNameCount;
+            mpHeader->mCapacity  = mCapacity;
+            mpNames  = reinterpret_cast<trace_details::NameEntry *>(static_cast<char *>(p_map) + sizeof(trace_details::FileHeader));
+            mpEvents = reinterpret_cast<trace_details::EventSlot *>(mpNames + trace_details::kNameCount);
+        }
+
+        /**
+         * @brief Destructor, it unmaps the trace file
+         */
+        ~TraceRecorder(void)
+        {
+            ::munmap(mpHeader, mSize);
+        }
+
+        /**
+         * @brief  Get the current time, in nanoseconds from the recorder creation
+         * @return Current time
+         */
+        std::uint64_t Now(void) const
+        {
+            return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - mStartTime).count());
+        }
+
+        /**
+         * @brief     Record an event that started at the specified time and ends now
+         * @param[in] cType       Event type
+         * @param[in] cTypeId     Interface type id, see trace_details::GetTypeId
+         * @param[in] cStartNs    Start time, as returned by Now
+         * @param[in] cArgBytes   Size of the arguments, in bytes
+         * @param[in] pcTypeName  Interface name, added to the name table if not already present (nullptr for none)
+         * @return    void
+         */
+        void Record(const TraceEventType cType,
+                    const std::uint64_t cTypeId,
+                    const std::uint64_t cStartNs,
+                    const std::size_t cArgBytes = 0,
+                    const char* pcTypeName = nullptr)
+        {
+            const std::uint64_t end_ns   = Now();
+            const std::uint64_t sequence = mpHeader->mCursor.fetch_add(1, std::memory_order_relaxed);
+
+            if (pcTypeName != nullptr)
+            {
+                AddName(cTypeId, pcTypeName);
+            }
+
+            // Mark the slot as busy, unless it's written by another thread or it already holds a newer event
+            trace_details::EventSlot& slot = mpEvents[sequence % mCapacity];
+            std::uint64_t slot_sequence = slot.mSequence.load(std::memory_order_relaxed);
+            if ((slot_sequence == trace_details::kBusySequence) || (slot_sequence > sequence) ||
+                !slot.mSequence.compare_exchange_strong(slot_sequence, trace_details::kBusySequence, std::memory_order_acquire))
+            {
+                return;
+            }
+
+            slot.mTimestampNs = cStartNs;
+            slot.mTypeId      = cTypeId;
+            slot.mDurationNs  = trace_details::Saturate<std::uint32_t>(end_ns - cStartNs);
+            slot.mThreadId    = trace_details::GetThreadId();
+            slot.mArgBytes    = trace_details::Saturate<std::uint16_t>(cArgBytes);
+            slot.mType        = cType;
+            slot.mSequence.store(sequence + 1, std::memory_order_release);
+        }
+
+    /*
+     * Private methods
+     */
+    private:
+        /**
+         * @brief     Add an interface name to the name table, if not already present. The table is indexed by type id
+         *            with linear probing, names that don't fit in it are not added.
+         * @param[in] cTypeId    Interface type id
+         * @param[in] pcTypeName Interface name
+         * @return    void
+         */
+        void AddName(const std::uint64_t cTypeId,
+                     const char* pcTypeName)
+        {
+            for (std::uint32_t i = 0; i < trace_details::kNameCount; i++)
+            {
+                trace_details::NameEntry& entry = mpNames[(cTypeId + i) % trace_details::kNameCount];
+
+                std::uint64_t entry_type_id = entry.mTypeId.load(std::memory_order_acquire);
+                if ((entry_type_id == 0) && entry.mTypeId.compare_exchange_strong(entry_type_id, cTypeId, std::memory_order_acq_rel))
+                {
+                    std::strncpy(entry.mName, pcTypeName, trace_details::kNameLength);
+                    entry.mReady.store(1, std::memory_order_release);
+                    return;
+                }
+                if (entry_type_id == cTypeId)
+                {
+                    return;
+                }
+            }
+        }
+
+    /*
+     * Members
+     */
+    private:
+        const std::chrono::steady_clock::time_point mStartTime;     /**< Creation time   */
+        const std::size_t                           mCapacity;      /**< Ring capacity   */
+        const std::size_t                           mSize;          /**< Mapping size    */
+        trace_details::FileHeader                  *mpHeader;       /**< File header     */
+        trace_details::NameEntry                   *mpNames;        /**< Name table      */
+        trace_details::EventSlot                   *mpEvents;       /**< Events ring     */
+};
+
+/**
+ * @brief Trace reader class.
+ *        It reads the events of a trace file, ordered by sequence, and the names of the recorded interfaces.
+ */
+class TraceReader
+{
+    /*
+     * Public methods
+     */
+    public:
+        /**
+         * @brief     Read the events of a trace file. Incomplete events (e.g. interrupted by a crash) are skipped.
+         *            TraceFileEx is thrown if the file cannot be read or it's not valid.
+         * @param[in] rcPath Trace file path
+         * @return    Events, from the oldest to the newest
+         */
+        static std::vector<TraceEvent> Read(const std::string& rcPath)
+        {
+            const std::vector<char> cBuffer = ReadFile(rcPath);
+            const auto* pcHeader = reinterpret_cast<const trace_details::FileHeader *>(cBuffer.data());
+            const char* pcEvents = cBuffer.data() + GetEventsOffset(*pcHeader);
+
+            // Copy the complete events, whose sequence matches their position, then order them
+            const std::uint64_t cCursor = pcHeader->mCursor.load();
+            std::vector<TraceEvent> events;
+            events.reserve(static_cast<std::size_t>(std::min<std::uint64_t>(pcHeader->mCapacity, cCursor)));
+            for (std::uint64_t i = 0; i < pcHeader->mCapacity; i++)
+            {
+                TraceEvent event;
+                std::memcpy(&event, pcEvents + i * sizeof(TraceEvent), sizeof(TraceEvent));
+                if ((event.mSequence != 0) && (event.mSequence <= cCursor) && (((event.mSequence - 1) % pcHeader->mCapacity) == i))
+                {
+                    events.push_back(event);
+                }
+            }
+            std::sort(std::begin(events), std::end(events),
+                      [](const TraceEvent& rcEvent1, const TraceEvent& rcEvent2) { return rcEvent1.mSequence < rcEvent2.mSequence; });
+
+            return events;
+        }
+
+        /**
+         * @brief     Read the names of the interfaces recorded in a trace file.
+         *            TraceFileEx is thrown if the file cannot be read or it's not valid.
+         * @param[in] rcPath Trace file path
+         * @return    Interface names, by type id
+         */
+        static std::map<std::uint64_t, std::string> ReadNames(const std::string& rcPath)
+        {
+            const std::vector<char> cBuffer = ReadFile(rcPath);
+            const auto* pcHeader = reinterpret_cast<const trace_details::FileHeader *>(cBuffer.data());
+            const auto* pcNames  = reinterpret_cast<const trace_details::NameEntry *>(cBuffer.data() + sizeof(trace_details::FileHeader));
+
+            std::map<std::uint64_t, std::string> names;
+            for (std::uint32_t i = 0; i < pcHeader->mNameCount; i++)
+            {
+                if ((pcNames[i].mTypeId.load() != 0) && (pcNames[i].mReady.load() != 0))
+                {
+                    names.emplace(pcNames[i].mTypeId.load(), std::string(pcNames[i].mName, ::strnlen(pcNames[i].mName, trace_details::kNameLength)));
+                }
+            }
+
+            return names;
+        }
+
+    /*
+     * Private methods
+     */
+    private:
+        /**
+         * @brief     Get the offset of the events ring in a trace file
+         * @param[in] rcHeader File header
+         * @return    Offset, in bytes
+         */
+        static std::size_t GetEventsOffset(const trace_details::FileHeader& rcHeader)
+        {
+            return sizeof(trace_details::FileHeader) + rcHeader.mNameCount * sizeof(trace_details::NameEntry);
+        }
+
+        /**
+         * @brief     Read a trace file and check its header.
+         *            TraceFileEx is thrown if the file cannot be read or it's not valid.
+         * @param[in] rcPath Trace file path
+         * @return    File content
+         */
+        static std::vector<char> ReadFile(const std::string& rcPath)
+        {
+            const int fd = ::open(rcPath.c_str(), O_RDONLY);
+            if (fd < 0)
+            {
+                throw TraceFileEx(rcPath, std::strerror(errno));
+            }
+
+            struct stat file_stat;
+            std::vector<char> buffer;
+            if (::fstat(fd, &file_stat) == 0)
+            {
+                buffer.resize(static_cast<std::size_t>(file_stat.st_size));
+                std::size_t offset = 0;
+                while (offset < buffer.size())
+                {
+                    const ssize_t read_size = ::read(fd, buffer.data() + offset, buffer.size() - offset);
+                    if (read_size <= 0)
+                    {
+                        break;
+                    }
+                    offset += static_cast<std::size_t>(read_size);
+                }
+                buffer.resize(offset);
+            }
+            ::close(fd);
+
+            // Check header, the sizes are checked without overflowing since they come from the file
+            const auto* p_header = reinterpret_cast<const trace_details::FileHeader *>(buffer.data());
+            if ((buffer.size() < sizeof(trace_details::FileHeader)) ||
+                (std::memcmp(p_header->mMagic, trace_details::kMagic, sizeof(trace_details::kMagic)) != 0) ||
+                (p_header->mEventSize != sizeof(TraceEvent)) ||
+                (p_header->mNameCount > trace_details::kNameCount) ||
+                (p_header->mCapacity == 0) ||
+                (buffer.size() < GetEventsOffset(*p_header)) ||
+                (p_header->mCapacity > (buffer.size() - GetEventsOffset(*p_header)) / sizeof(TraceEvent)))
+            {
+                throw TraceFileEx(rcPath, "invalid trace file");
+            }
+
+            return buffer;
+        }
+};
+
+}   // namespace factory_injector
+
+#endif  // _FACTORY_INJECTOR_TRACE_RECORDER_HPP_
@@ -0,0 +1,258 @@
+/**
+ * Copyright (c) 2020 Emanuele Bellocchia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Includes
+ */
+
+// Google test
+#include "gtest/gtest.h"
+// Standard
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+// Utils
+#include "ut_utils.hpp"
+// Class under test
+#include "deferred_delete.hpp"
+#include "factory_injector.hpp"
+
+
+/*
+ * Using directives
+ */
+using namespace factory_injector;
+
+/*
+ * Global variables
+ */
+
+// Number of destroyed objects
+static std::atomic<int> gDestroyedCount(0);
+// Threads that destroyed objects
+static std::set<std::thread::id> gDestroyerThreads;
+// Mutex for the destroyer threads
+static std::mutex gDestroyerMutex;
+
+/*
+ * Classes
+ */
+
+// Deferred class interface
+class IDeferredClass
+{
+    public:
+      virtual ~IDeferredClass(void) = default;
+};
+
+// Deferred class, it counts its destructions
+class DeferredClass : public IDeferredClass
+{
+    public:
+      ~DeferredClass(void) override
+      {
+          std::lock_guard<std::mutex> lock(gDestroyerMutex);
+          gDestroyerThreads.insert(std::this_thread::get_id());
+          gDestroyedCount++;
+      }
+};
+
+// Deferred class that flushes the deferred objects when destroyed
+class FlushingDeferredClass : public DeferredClass
+{
+    public:
+      ~FlushingDeferredClass(void) override
+      {
+          DeferredDelete::Flush();
+      }
+};
+
+// Deferred class factory interface
+class IDeferredClassFactory : public FactoryTraits<IDeferredClassFactory, IDeferredClass, DeferredDelete>
+{
+    public:
+      virtual ~IDeferredClassFactory(void)  = default;
+      virtual tObjectPtr Create(void) const = 0;
+};
+
+// Deferred class factory
+class DeferredClassFactory : public IDeferredClassFactory
+{
+    public:
+      tObjectPtr Create(void) const override
+      {
+          return std::make_unique<DeferredClass>();
+      }
+};
+
+// Holder of a deferred object, used as thread-local for releasing the object when the thread exits
+struct ThreadExitHolder
+{
+    IDeferredClassFactory::tObjectPtr mObjPtr;
+};
+
+/*
+ * Test fixture
+ */
+
+// Fixture for deferred delete
+class UTDeferredDelete : public ::testing::Test
+{
+    /*
+     * Protected methods
+     */
+    protected:
+        // Set up
+        void SetUp(void) override
+        {
+            DeferredDelete::Flush();
+            gDestroyedCount = 0;
+            gDestroyerThreads.clear();
+
+            mFactoryInjector.RegisterFactory<DeferredClassFactory>();
+        }
+
+    /*
+     * Members
+     */
+    protected:
+        FactoryInjector mFactoryInjector;
+};
+
+/*
+ * Tests
+ */
+
+// Test that objects are destroyed by the background thread
+TEST_F(UTDeferredDelete, BackgroundDestruction)
+{
+    for (int i = 0; i < 100; i++)
+    {
+        auto obj_ptr = mFactoryInjector.CreateObject<IDeferredClassFactory>();
+        EXPECT_TRUE(ut_utils::IsOfType<DeferredClass>(*obj_ptr)) << "Wrong object type";
+    }
+
+    // Wait for the reclaimer
+    for (int i = 0; (i < 1000) && (gDestroyedCount < 100); i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    EXPECT_EQ(gDestroyedCount, 100) << "Objects not destroyed";
+
+    // The reclaimer shall be woken up by objects released after it went idle
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    mFactoryInjector.CreateObject<IDeferredClassFactory>();
+    for (int i = 0; (i < 1000) && (gDestroyedCount < 101); i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    EXPECT_EQ(gDestroyedCount, 101) << "Objects not destroyed after idle";
+    std::lock_guard<std::mutex> lock(gDestroyerMutex);
+    EXPECT_EQ(gDestroyerThreads.count(std::this_thread::get_id()), 0u) << "Objects destroyed by the releasing thread";
+}
+
+// Test for Flush
+TEST_F(UTDeferredDelete, Flush)
+{
+    std::vector<IDeferredClassFactory::tObjectPtr> objects;
+    for (int i = 0; i < 100; i++)
+    {
+        objects.push_back(mFactoryInjector.CreateObject<IDeferredClassFactory>());
+    }
+    objects.clear();
+
+    DeferredDelete::Flush();
+    EXPECT_EQ(gDestroyedCount, 100) << "Objects not destroyed by Flush";
+
+    // Objects released by other threads, which already exited
+    std::thread thread([this]()
+                       {
+                           for (int i = 0; i < 100; i++)
+                           {
+                               mFactoryInjector.CreateObject<IDeferredClassFactory>();
+                           }
+                       });
+    thread.join();
+
+    DeferredDelete::Flush();
+    EXPECT_EQ(gDestroyedCount, 200) << "Objects of other threads not destroyed by Flush";
+}
+
+// Test for Flush called while deleting objects, it shall not deadlock
+TEST_F(UTDeferredDelete, FlushFromDestructor)
+{
+    // Deleted by Flush
+    for (int i = 0; i < 10; i++)
+    {
+        IDeferredClassFactory::tObjectPtr obj_ptr(new FlushingDeferredClass());
+    }
+    DeferredDelete::Flush();
+    EXPECT_EQ(gDestroyedCount, 10) << "Objects not destroyed by Flush";
+
+    // Deleted by the background thread
+    for (int i = 0; i < 10; i++)
+    {
+        IDeferredClassFactory::tObjectPtr obj_ptr(new FlushingDeferredClass());
+    }
+    for (int i = 0; (i < 1000) && (gDestroyedCount < 20); i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(gDestroyedCount, 20) << "Objects not destroyed by the background thread";
+}
+
+// Test that objects are destroyed immediately when the queue is full
+TEST_F(UTDeferredDelete, QueueFull)
+{
+    const int count = static_cast<int>(4 * deferred_details::kQueueSize);
+
+    std::vector<IDeferredClassFactory::tObjectPtr> objects;
+    for (int i = 0; i < count; i++)
+    {
+        objects.push_back(mFactoryInjector.CreateObject<IDeferredClassFactory>());
+    }
+    objects.clear();
+
+    DeferredDelete::Flush();
+    EXPECT_EQ(gDestroyedCount, count) << "Objects not destroyed";
+}
+
+// Test for objects released when their thread exits, after its retire queue has been destroyed
+TEST_F(UTDeferredDelete, ReleaseAtThreadExit)
+{
+    std::thread thread([this]()
+                       {
+                           // Constructed before the retire queue of the thread, so it's destroyed after it
+                           thread_local ThreadExitHolder holder;
+                           holder.mObjPtr = mFactoryInjector.CreateObject<IDeferredClassFactory>();
+                           mFactoryInjector.CreateObject<IDeferredClassFactory>();
+                       });
+    thread.join();
+
+    DeferredDelete::Flush();
+    EXPECT_EQ(gDestroyedCount, 2) << "Objects not destroyed";
+}
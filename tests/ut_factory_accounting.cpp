@@ -0,0 +1,252 @@
+/**
+ * Copyright (c) 2020 Emanuele Bellocchia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Includes
+ */
+
+// Google test
+#include "gtest/gtest.h"
+// Standard
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+// Utils
+#include "ut_utils.hpp"
+// Class under test
+#include "deferred_delete.hpp"
+#include "factory_injector.hpp"
+
+
+/*
+ * Using directives
+ */
+using namespace factory_injector;
+
+/*
+ * Classes
+ */
+
+// Accounted class interface
+class IAccountedClass
+{
+    public:
+      virtual ~IAccountedClass(void) = default;
+};
+
+// Accounted class
+class AccountedClass : public IAccountedClass
+{
+    private:
+      char mPayload[100];
+};
+
+// Accounted class factory interface
+class IAccountedClassFactory : public FactoryTraits<IAccountedClassFactory, IAccountedClass>
+{
+    public:
+      virtual ~IAccountedClassFactory(void)         = default;
+      virtual tObjectPtr Create(void) const         = 0;
+      virtual tObjectPtr Create(const int) const    = 0;
+};
+
+// Accounted class factory
+class AccountedClassFactory : public IAccountedClassFactory
+{
+    public:
+      tObjectPtr Create(void) const override
+      {
+          return std::make_unique<AccountedClass>();
+      }
+
+      tObjectPtr Create(const int) const override
+      {
+          return std::make_unique<AccountedClass>();
+      }
+};
+
+// Deferred accounted class factory interface
+class IDeferredAccountedClassFactory : public FactoryTraits<IDeferredAccountedClassFactory, IAccountedClass, DeferredDelete>
+{
+    public:
+      virtual ~IDeferredAccountedClassFactory(void) = default;
+      virtual tObjectPtr Create(void) const         = 0;
+};
+
+// Deferred accounted class factory
+class DeferredAccountedClassFactory : public IDeferredAccountedClassFactory
+{
+    public:
+      tObjectPtr Create(void) const override
+      {
+          return std::make_unique<AccountedClass>();
+      }
+};
+
+/*
+ * Test fixture
+ */
+
+// Fixture for factory accounting
+class UTFactoryAccounting : public ::testing::Test
+{
+    /*
+     * Public methods
+     */
+    public:
+        // Constructor
+        UTFactoryAccounting(void)
+        {}
+
+        // Set up, it takes a baseline of the counters since they're shared by all the injectors of the process
+        void SetUp(void) override
+        {
+            FactoryInjector baseline_injector;
+            baseline_injector.RegisterFactory<AccountedClassFactory>();
+            baseline_injector.RegisterFactory<DeferredAccountedClassFactory>();
+
+            for (auto& info : baseline_injector.GetAccountingSnapshot())
+            {
+                mBaselines[info.mInterfaceName] = info;
+            }
+        }
+
+        // Get the accounting information of the registered factory, relative to the baseline
+        FactoryAccountingInfo GetInfo(void) const
+        {
+            auto snapshot = mFactoryInjector.GetAccountingSnapshot();
+            EXPECT_EQ(snapshot.size(), 1u) << "Wrong snapshot size";
+
+            auto info = snapshot.at(0);
+            const auto& baseline = mBaselines.at(info.mInterfaceName);
+            info.mLiveObjects    -= baseline.mLiveObjects;
+            info.mCreatedObjects -= baseline.mCreatedObjects;
+            info.mLiveBytes      -= baseline.mLiveBytes;
+            info.mCreatedBytes   -= baseline.mCreatedBytes;
+
+            return info;
+        }
+
+    /*
+     * Members
+     */
+    protected:
+        FactoryInjector                              mFactoryInjector;
+        std::map<std::string, FactoryAccountingInfo> mBaselines;
+};
+
+/*
+ * Tests
+ */
+
+// Test for accounting objects created by CreateObject
+TEST_F(UTFactoryAccounting, CreateObject)
+{
+    // Register factory
+    mFactoryInjector.RegisterFactory<AccountedClassFactory>();
+
+    auto info = GetInfo();
+    EXPECT_EQ(info.mInterfaceName, typeid(IAccountedClassFactory).name()) << "Wrong interface name";
+    EXPECT_EQ(info.mLiveObjects, 0)                                       << "Wrong live objects after registering";
+    EXPECT_GT(info.mRegistrationBytes, sizeof(AccountedClassFactory))     << "Wrong registration bytes";
+
+    // Create some objects and destroy one of them
+    auto obj_ptr_1 = mFactoryInjector.CreateObject<IAccountedClassFactory>();
+    auto obj_ptr_2 = mFactoryInjector.CreateObject<IAccountedClassFactory>();
+    {
+        auto obj_ptr_3 = mFactoryInjector.CreateObject<AccountedClassFactory>();
+        EXPECT_TRUE(ut_utils::IsOfType<AccountedClass>(*obj_ptr_3)) << "Wrong object type";
+    }
+
+    info = GetInfo();
+    EXPECT_EQ(info.mLiveObjects,    2)                                           << "Wrong live objects";
+    EXPECT_EQ(info.mCreatedObjects, 3)                                           << "Wrong created objects";
+    EXPECT_EQ(info.mLiveBytes,      static_cast<std::int64_t>(2 * sizeof(AccountedClass))) << "Wrong live bytes";
+    EXPECT_EQ(info.mCreatedBytes,   static_cast<std::int64_t>(3 * sizeof(AccountedClass))) << "Wrong created bytes";
+
+    // Objects created directly by the factory are not accounted
+    auto obj_ptr_4 = mFactoryInjector.GetFactory<IAccountedClassFactory>().Create();
+    EXPECT_EQ(GetInfo().mCreatedObjects, 3) << "Object created by factory accounted";
+
+    // Destroy all objects
+    obj_ptr_1.reset();
+    obj_ptr_2.reset();
+    info = GetInfo();
+    EXPECT_EQ(info.mLiveObjects, 0) << "Wrong live objects after destroying";
+    EXPECT_EQ(info.mLiveBytes,   0) << "Wrong live bytes after destroying";
+}
+
+// Test for accounting objects destroyed by other threads
+TEST_F(UTFactoryAccounting, DestroyFromOtherThread)
+{
+    // Register factory
+    mFactoryInjector.OverwriteFactory<AccountedClassFactory>();
+
+    // Create objects here and destroy them in another thread
+    std::vector<IAccountedClassFactory::tObjectPtr> objects;
+    for (int i = 0; i < 10; i++)
+    {
+        objects.push_back(mFactoryInjector.CreateObject<IAccountedClassFactory>());
+    }
+    std::thread other_thread([&]() { objects.clear(); });
+    other_thread.join();
+
+    auto info = GetInfo();
+    EXPECT_EQ(info.mLiveObjects,    0)  << "Wrong live objects";
+    EXPECT_EQ(info.mCreatedObjects, 10) << "Wrong created objects";
+}
+
+// Test for accounting objects created by a generator
+TEST_F(UTFactoryAccounting, Generate)
+{
+    // Register factory
+    mFactoryInjector.OverwriteFactory<AccountedClassFactory>();
+
+    std::vector<IAccountedClassFactory::tObjectPtr> objects;
+    for (auto& obj_ptr : mFactoryInjector.Generate<IAccountedClassFactory>(std::vector<int>{ 1, 2, 3, 4, 5 }, 2))
+    {
+        objects.push_back(std::move(obj_ptr));
+    }
+
+    auto info = GetInfo();
+    EXPECT_EQ(info.mLiveObjects,    5) << "Wrong live objects";
+    EXPECT_EQ(info.mCreatedObjects, 5) << "Wrong created objects";
+
+    objects.clear();
+    EXPECT_EQ(GetInfo().mLiveObjects, 0) << "Wrong live objects after destroying";
+}
+
+// Test for accounting objects with deferred delete
+TEST_F(UTFactoryAccounting, DeferredDelete)
+{
+    // Register factory
+    mFactoryInjector.OverwriteFactory<DeferredAccountedClassFactory>();
+
+    auto obj_ptr = mFactoryInjector.CreateObject<IDeferredAccountedClassFactory>();
+    EXPECT_EQ(GetInfo().mLiveObjects, 1) << "Wrong live objects";
+
+    // Objects are accounted as destroyed when released, even if they're deleted later
+    obj_ptr.reset();
+    EXPECT_EQ(GetInfo().mLiveObjects, 0) << "Wrong live objects after releasing";
+    DeferredDelete::Flush();
+}
@@ -0,0 +1,157 @@
+/**
+ * Copyright (c) 2020 Emanuele Bellocchia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Includes
+ */
+
+// Google test
+#include "gtest/gtest.h"
+// Standard
+#include <string>
+#include <vector>
+// Utils
+#include "ut_utils.hpp"
+// Class under test
+#include "factory_decorators.hpp"
+#include "factory_injector.hpp"
+
+
+/*
+ * Using directives
+ */
+using namespace factory_injector;
+
+/*
+ * Global variables
+ */
+
+// Trace of the policies calls
+static std::vector<std::string> gTrace;
+
+/*
+ * Classes
+ */
+
+// Decorated class interface
+class IDecoratedClass
+{
+    public:
+      virtual ~IDecoratedClass(void) = default;
+      virtual int GetValue(void) const = 0;
+};
+
+// Decorated class
+class DecoratedClass : public IDecoratedClass
+{
+    public:
+      DecoratedClass(const int cValue) :
+        mValue(cValue)
+      {}
+
+      int GetValue(void) const override
+      {
+          return mValue;
+      }
+
+    private:
+      int mValue;
+};
+
+// Decorated class factory interface
+class IDecoratedClassFactory : public FactoryTraits<IDecoratedClassFactory, IDecoratedClass>
+{
+    public:
+      virtual ~IDecoratedClassFactory(void)             = default;
+      virtual tObjectPtr Create(const int cValue) const = 0;
+};
+
+// Decorated class factory, it adds an offset to the value
+class DecoratedClassFactory : public IDecoratedClassFactory
+{
+    public:
+      DecoratedClassFactory(const int cOffset = 0) :
+        mOffset(cOffset)
+      {}
+
+      tObjectPtr Create(const int cValue) const override
+      {
+          gTrace.push_back("create");
+          return std::make_unique<DecoratedClass>(cValue + mOffset);
+      }
+
+    private:
+      int mOffset;
+};
+
+// Tracing policy, it traces the first Create argument too
+template<int TId>
+class Traced
+{
+    public:
+      template<class TCreate>
+      auto Around(const TCreate& rcCreate,
+                  const int cValue) const -> decltype(rcCreate())
+      {
+          gTrace.push_back("before " + std::to_string(TId) + " " + std::to_string(cValue));
+          auto obj_ptr = rcCreate();
+          gTrace.push_back("after " + std::to_string(TId));
+          return obj_ptr;
+      }
+};
+
+/*
+ * Tests
+ */
+
+// Test for policies order and arguments
+TEST(UTFactoryDecorators, PoliciesOrder)
+{
+    using tDecoratedFactory = Decorated<DecoratedClassFactory, Traced<1>, Traced<2>>;
+
+    FactoryInjector factory_injector;
+    factory_injector.RegisterFactory<tDecoratedFactory>(10);
+
+    gTrace.clear();
+    EXPECT_EQ(factory_injector.CreateObject<IDecoratedClassFactory>(1)->GetValue(), 11) << "Wrong object from decorated factory";
+
+    const std::vector<std::string> expected_trace = { "before 1 1", "before 2 1", "create", "after 2", "after 1" };
+    EXPECT_EQ(gTrace, expected_trace) << "Wrong policies order";
+}
+
+// Test for common policies
+TEST(UTFactoryDecorators, CommonPolicies)
+{
+    using tDecoratedFactory = Decorated<DecoratedClassFactory, Counted, Timed, Synchronized>;
+
+    FactoryInjector factory_injector;
+    factory_injector.RegisterFactory<tDecoratedFactory>();
+
+    for (int i = 0; i < 10; i++)
+    {
+        EXPECT_EQ(factory_injector.CreateObject<IDecoratedClassFactory>(i)->GetValue(), i) << "Wrong object from decorated factory";
+    }
+
+    const auto& factory = static_cast<const tDecoratedFactory&>(factory_injector.GetFactory<IDecoratedClassFactory>());
+    EXPECT_EQ(factory.GetPolicy<Counted>().GetCount(), 10u) << "Wrong count";
+    EXPECT_GT(factory.GetPolicy<Timed>().GetTotalTime().count(), 0) << "Wrong time";
+}
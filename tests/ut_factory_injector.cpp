@@ -26,6 +26,16 @@
 
 // Google test
 #include "gtest/gtest.h"
+// Standard
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <thread>
+#include <tuple>
+#include <vector>
 // Utils
 #include "ut_utils.hpp"
 // Class under test
@@ -84,6 +94,183 @@ class DummyClass2Factory : public IDummyClassFactory
       }
 };
 
+// Stateful factory, it keeps the value it was constructed with
+class StatefulClassFactory : public IDummyClassFactory
+{
+    public:
+      StatefulClassFactory(const int cValue) :
+        mValue(cValue)
+      {}
+
+      tObjectPtr Create(void) const override
+      {
+          mCreatedCount++;
+          return std::make_unique<DummyClass1>();
+      }
+
+      int GetValue(void) const
+      {
+          return mValue;
+      }
+
+      int GetCreatedCount(void) const
+      {
+          return mCreatedCount;
+      }
+
+    private:
+      int mValue;
+      mutable int mCreatedCount = 0;
+};
+
+// Stateful factory class, it counts its live instances
+class LiveCountedFactory : public IDummyClassFactory
+{
+    public:
+      LiveCountedFactory(void)
+      {
+          GetLiveCountRef()++;
+      }
+
+      ~LiveCountedFactory(void)
+      {
+          GetLiveCountRef()--;
+      }
+
+      tObjectPtr Create(void) const override
+      {
+          mCreatedCount++;
+          return std::make_unique<DummyClass1>();
+      }
+
+      int GetCreatedCount(void) const
+      {
+          return mCreatedCount;
+      }
+
+      static int GetLiveCount(void)
+      {
+          return GetLiveCountRef();
+      }
+
+    private:
+      static std::atomic<int>& GetLiveCountRef(void)
+      {
+          static std::atomic<int> live_count(0);
+          return live_count;
+      }
+
+      mutable int mCreatedCount = 0;
+};
+
+// Value class, it keeps the value it was created with
+class ValueClass
+{
+    public:
+      ValueClass(const int cValue) :
+        mValue(cValue)
+      {}
+
+      int GetValue(void) const
+      {
+          return mValue;
+      }
+
+    private:
+      int mValue;
+};
+
+// Value class factory interface
+class IValueClassFactory : public FactoryTraits<IValueClassFactory, ValueClass>
+{
+    public:
+      virtual ~IValueClassFactory(void)                 = default;
+      virtual tObjectPtr Create(const int cValue) const = 0;
+      virtual tObjectPtr Create(const int cValue1,
+                                const int cValue2) const = 0;
+};
+
+// Value class factory, it counts the created objects
+class ValueClassFactory : public IValueClassFactory
+{
+    public:
+      tObjectPtr Create(const int cValue) const override
+      {
+          mCreatedCount++;
+          return std::make_unique<ValueClass>(cValue);
+      }
+
+      tObjectPtr Create(const int cValue1,
+                        const int cValue2) const override
+      {
+          mCreatedCount++;
+          return std::make_unique<ValueClass>(cValue1 + cValue2);
+      }
+
+      int GetCreatedCount(void) const
+      {
+          return mCreatedCount;
+      }
+
+    private:
+      mutable int mCreatedCount = 0;
+};
+
+// Composed value class factory, it creates objects from the shared objects of smaller values.
+// The creation of the gated value waits for the gate.
+class ComposedValueClassFactory : public IValueClassFactory
+{
+    public:
+      static constexpr int kGatedValue = -1;
+
+      ComposedValueClassFactory(const FactoryInjector& rcFactoryInjector,
+                                std::shared_future<void> gate) :
+        mrcFactoryInjector(rcFactoryInjector),
+        mGate(std::move(gate))
+      {}
+
+      tObjectPtr Create(const int cValue) const override
+      {
+          if (cValue == kGatedValue)
+          {
+              mGate.wait();
+          }
+          if (cValue <= 0)
+          {
+              return std::make_unique<ValueClass>(cValue);
+          }
+          return std::make_unique<ValueClass>(cValue + mrcFactoryInjector.GetOrCreateShared<IValueClassFactory>(cValue - 1)->GetValue());
+      }
+
+      tObjectPtr Create(const int cValue1,
+                        const int cValue2) const override
+      {
+          return std::make_unique<ValueClass>(cValue1 + cValue2);
+      }
+
+    private:
+      const FactoryInjector&   mrcFactoryInjector;
+      std::shared_future<void> mGate;
+};
+
+// Text class factory interface
+class ITextClassFactory : public FactoryTraits<ITextClassFactory, ValueClass>
+{
+    public:
+      virtual ~ITextClassFactory(void)                    = default;
+      virtual tObjectPtr Create(const char *pcText) const = 0;
+};
+
+// Text class factory, the object value is the text length
+class TextClassFactory : public ITextClassFactory
+{
+    public:
+      tObjectPtr Create(const char *pcText) const override
+      {
+          return std::make_unique<ValueClass>(static_cast<int>(std::strlen(pcText)));
+      }
+};
+
 // Other class factory interface
 class IOtherClassFactory : public FactoryTraits<IOtherClassFactory, IDummyClass>
 {
@@ -91,6 +278,47 @@ class IOtherClassFactory : public FactoryTraits<IOtherClassFactory, IDummyClass>
       virtual ~IOtherClassFactory(void) = default;
 };
 
+// Composite class factory interface
+class ICompositeClassFactory : public FactoryTraits<ICompositeClassFactory, ValueClass>
+{
+    public:
+      virtual ~ICompositeClassFactory(void)             = default;
+      virtual tObjectPtr Create(const int cValue) const = 0;
+};
+
+// Composite class factory, it creates objects by using other factories, which are auto-wired
+class CompositeClassFactory : public ICompositeClassFactory
+{
+    public:
+      CompositeClassFactory(const IValueClassFactory& rcValueFactory,
+                            const IDummyClassFactory& rcDummyFactory) :
+        mrcValueFactory(rcValueFactory),
+        mrcDummyFactory(rcDummyFactory)
+      {}
+
+      tObjectPtr Create(const int cValue) const override
+      {
+          mrcDummyFactory.Create();
+          return mrcValueFactory.Create(cValue, 1);
+      }
+
+      const IValueClassFactory& GetValueFactory(void) const
+      {
+          return mrcValueFactory;
+      }
+
+    private:
+      const IValueClassFactory& mrcValueFactory;
+      const IDummyClassFactory& mrcDummyFactory;
+};
+
+/*
+ * Static registrations
+ */
+
+FACTORY_INJECTOR_STATIC_REGISTER(DummyClass1Factory);
+FACTORY_INJECTOR_STATIC_REGISTER(ValueClassFactory);
+
 /*
  * Test fixture
  */
@@ -188,3 +416,383 @@ TEST_F(UTFactoryInjector, CreateObject)
     obj_ptr = mFactoryInjector.CreateObject<IDummyClassFactory>();
     EXPECT_TRUE(ut_utils::IsOfType<DummyClass1>(*obj_ptr)) << "Wrong object type when getting from interface type";
 }
+
+// Test for RegisterFactoryPerThread
+TEST_F(UTFactoryInjector, RegisterFactoryPerThread)
+{
+    // Register per-thread factory
+    mFactoryInjector.RegisterFactoryPerThread<StatefulClassFactory>(5);
+    EXPECT_THROW(mFactoryInjector.RegisterFactoryPerThread<StatefulClassFactory>(5), FactoryAlreadyRegisteredEx) << "Exception not thrown when registering an already existent factory";
+
+    // The same thread shall always get the same factory
+    auto& factory = mFactoryInjector.GetFactory<IDummyClassFactory>();
+    auto obj_ptr  = mFactoryInjector.CreateObject<IDummyClassFactory>();
+    EXPECT_TRUE(ut_utils::IsOfType<StatefulClassFactory>(factory)) << "Wrong factory type";
+    EXPECT_TRUE(ut_utils::IsOfType<DummyClass1>(*obj_ptr))         << "Wrong object type";
+    EXPECT_EQ(&factory, &mFactoryInjector.GetFactory<IDummyClassFactory>()) << "Different factories for the same thread";
+
+    auto& stateful_factory = static_cast<const StatefulClassFactory&>(factory);
+    EXPECT_EQ(stateful_factory.GetValue(), 5)        << "Wrong factory construction";
+    EXPECT_EQ(stateful_factory.GetCreatedCount(), 1) << "Wrong factory state";
+
+    // Another thread shall get its own factory, with its own state (checked before the thread exits,
+    // since its factory is destroyed then)
+    const StatefulClassFactory *p_other_factory = nullptr;
+    int other_value         = 0;
+    int other_created_count = 0;
+    std::thread other_thread([&]()
+    {
+        mFactoryInjector.CreateObject<IDummyClassFactory>();
+        mFactoryInjector.CreateObject<IDummyClassFactory>();
+        p_other_factory     = &static_cast<const StatefulClassFactory&>(mFactoryInjector.GetFactory<IDummyClassFactory>());
+        other_value         = p_other_factory->GetValue();
+        other_created_count = p_other_factory->GetCreatedCount();
+    });
+    other_thread.join();
+
+    EXPECT_NE(p_other_factory, &stateful_factory)         << "Same factory for different threads";
+    EXPECT_EQ(other_value, 5)                             << "Wrong factory construction";
+    EXPECT_EQ(other_created_count, 2)                     << "Wrong factory state";
+    EXPECT_EQ(stateful_factory.GetCreatedCount(), 1)      << "Factory state shared between threads";
+
+    // Overwriting shall replace the per-thread factories
+    mFactoryInjector.OverwriteFactory<DummyClass2Factory>();
+    EXPECT_TRUE(ut_utils::IsOfType<DummyClass2Factory>(mFactoryInjector.GetFactory<IDummyClassFactory>())) << "Wrong factory type after overwriting";
+}
+
+// Test for per-thread factories with thread churn
+TEST_F(UTFactoryInjector, PerThreadFactoryThreadExit)
+{
+    mFactoryInjector.RegisterFactoryPerThread<LiveCountedFactory>();
+    EXPECT_EQ(LiveCountedFactory::GetLiveCount(), 0) << "Replica constructed before being used";
+
+    // Each thread shall get a new replica, released when the thread exits
+    for (int i = 0; i < 50; i++)
+    {
+        int created_count = -1;
+        std::thread churn_thread([&]()
+        {
+            mFactoryInjector.CreateObject<IDummyClassFactory>();
+            created_count = static_cast<const LiveCountedFactory&>(mFactoryInjector.GetFactory<IDummyClassFactory>()).GetCreatedCount();
+        });
+        churn_thread.join();
+
+        EXPECT_EQ(created_count, 1) << "Replica of an exited thread reused";
+        EXPECT_EQ(LiveCountedFactory::GetLiveCount(), 0) << "Replica not released on thread exit";
+    }
+
+    // Replicas of threads still running shall be released with the container
+    mFactoryInjector.CreateObject<IDummyClassFactory>();
+    EXPECT_EQ(LiveCountedFactory::GetLiveCount(), 1) << "Wrong number of replicas";
+    mFactoryInjector.OverwriteFactory<DummyClass1Factory>();
+    EXPECT_EQ(LiveCountedFactory::GetLiveCount(), 0) << "Replica not released with the container";
+}
+
+// Test for Generate
+TEST_F(UTFactoryInjector, Generate)
+{
+    // Register factory
+    mFactoryInjector.RegisterFactory<ValueClassFactory>();
+    auto& factory = static_cast<const ValueClassFactory&>(mFactoryInjector.GetFactory<IValueClassFactory>());
+
+    // Objects shall be created lazily, one chunk at a time
+    std::vector<int> args = { 1, 2, 3, 4, 5 };
+    auto generator = mFactoryInjector.Generate<IValueClassFactory>(args, 2);
+    EXPECT_EQ(factory.GetCreatedCount(), 0) << "Objects created before iterating";
+
+    std::vector<IValueClassFactory::tObjectPtr> objects;
+    for (auto& obj_ptr : generator)
+    {
+        // Only the chunk containing the current object shall be created
+        auto expected_count = std::min(((objects.size() / 2) + 1) * 2, args.size());
+        EXPECT_EQ(factory.GetCreatedCount(), static_cast<int>(expected_count)) << "Wrong chunk creation";
+        objects.push_back(std::move(obj_ptr));
+    }
+
+    ASSERT_EQ(objects.size(), args.size()) << "Wrong number of generated objects";
+    for (std::size_t i = 0; i < objects.size(); i++)
+    {
+        EXPECT_EQ(objects[i]->GetValue(), args[i]) << "Wrong generated object";
+    }
+
+    // Tuple arguments shall be unpacked
+    std::vector<int> values;
+    for (auto& obj_ptr : mFactoryInjector.Generate<IValueClassFactory>(std::vector<std::tuple<int, int>>{ { 1, 10 }, { 2, 20 } }))
+    {
+        values.push_back(obj_ptr->GetValue());
+    }
+    EXPECT_EQ(values, std::vector<int>({ 11, 22 })) << "Wrong generated objects from tuples";
+
+    // Empty range
+    auto empty_generator = mFactoryInjector.Generate<IValueClassFactory>(std::vector<int>());
+    EXPECT_TRUE(empty_generator.begin() == empty_generator.end()) << "Objects generated from empty range";
+}
+
+// Test for GetOrCreateShared
+TEST_F(UTFactoryInjector, GetOrCreateShared)
+{
+    // Register factory
+    mFactoryInjector.RegisterFactory<ValueClassFactory>();
+    auto& factory = static_cast<const ValueClassFactory&>(mFactoryInjector.GetFactory<IValueClassFactory>());
+
+    // Equal arguments shall return the same object
+    auto obj_ptr_1 = mFactoryInjector.GetOrCreateShared<IValueClassFactory>(1);
+    auto obj_ptr_2 = mFactoryInjector.GetOrCreateShared<IValueClassFactory>(1);
+    auto obj_ptr_3 = mFactoryInjector.GetOrCreateShared<IValueClassFactory>(2);
+    auto obj_ptr_4 = mFactoryInjector.GetOrCreateShared<IValueClassFactory>(1, 1);
+    EXPECT_EQ(obj_ptr_1, obj_ptr_2)         << "Different objects for equal arguments";
+    EXPECT_NE(obj_ptr_1, obj_ptr_3)         << "Same object for different arguments";
+    EXPECT_NE(obj_ptr_3, obj_ptr_4)         << "Same object for different argument types";
+    EXPECT_EQ(obj_ptr_1->GetValue(), 1)     << "Wrong shared object";
+    EXPECT_EQ(obj_ptr_3->GetValue(), 2)     << "Wrong shared object";
+    EXPECT_EQ(obj_ptr_4->GetValue(), 2)     << "Wrong shared object";
+    EXPECT_EQ(factory.GetCreatedCount(), 3) << "Wrong number of created objects";
+
+    // With capacity 1, the least recently used object shall be evicted
+    mFactoryInjector.SetSharedCacheCapacity<IValueClassFactory>(1);
+    EXPECT_EQ(mFactoryInjector.GetOrCreateShared<IValueClassFactory>(2), obj_ptr_3) << "Most recently used object evicted";
+    EXPECT_NE(mFactoryInjector.GetOrCreateShared<IValueClassFactory>(1), obj_ptr_1) << "Least recently used object not evicted";
+    EXPECT_EQ(factory.GetCreatedCount(), 4) << "Wrong number of created objects";
+
+    // Overwriting the factory shall clear the cache, objects shall be still valid
+    mFactoryInjector.OverwriteFactory<ValueClassFactory>();
+    auto obj_ptr_5 = mFactoryInjector.GetOrCreateShared<IValueClassFactory>(2);
+    EXPECT_NE(obj_ptr_5, obj_ptr_3)     << "Cache not cleared after overwriting";
+    EXPECT_EQ(obj_ptr_3->GetValue(), 2) << "Shared object not valid after overwriting";
+
+    // The capacity shall be kept after overwriting
+    mFactoryInjector.GetOrCreateShared<IValueClassFactory>(3);
+    EXPECT_NE(mFactoryInjector.GetOrCreateShared<IValueClassFactory>(2), obj_ptr_5) << "Capacity not kept after overwriting";
+
+    // Getting a not-existent factory shall throw exception
+    EXPECT_THROW(mFactoryInjector.GetOrCreateShared<IDummyClassFactory>(), FactoryNotRegisteredEx) << "Exception not thrown when getting a not existent factory";
+}
+
+// Test for GetOrCreateShared without arguments, used as singleton
+TEST_F(UTFactoryInjector, GetOrCreateSharedSingleton)
+{
+    // Register factory
+    mFactoryInjector.RegisterFactory<StatefulClassFactory>(0);
+
+    // All threads shall get the same object
+    std::vector<std::shared_ptr<const IDummyClass>> objects(8);
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < objects.size(); i++)
+    {
+        threads.emplace_back([&, i]() { objects[i] = mFactoryInjector.GetOrCreateShared<IDummyClassFactory>(); });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (const auto& obj_ptr : objects)
+    {
+        EXPECT_EQ(obj_ptr, objects[0]) << "Different singleton objects";
+    }
+    EXPECT_TRUE(ut_utils::IsOfType<DummyClass1>(*objects[0])) << "Wrong singleton object type";
+    EXPECT_EQ(static_cast<const StatefulClassFactory&>(mFactoryInjector.GetFactory<IDummyClassFactory>()).GetCreatedCount(), 1) << "Singleton created multiple times";
+}
+
+// Test for GetOrCreateShared with concurrent and nested creations
+TEST_F(UTFactoryInjector, GetOrCreateSharedConcurrent)
+{
+    // Register factory
+    std::promise<void> gate;
+    mFactoryInjector.RegisterFactory<ComposedValueClassFactory>(mFactoryInjector, gate.get_future().share());
+
+    // The factory shall be able to get other shared objects while creating one
+    auto obj_ptr = mFactoryInjector.GetOrCreateShared<IValueClassFactory>(3);
+    EXPECT_EQ(obj_ptr->GetValue(), 6) << "Wrong composed object";
+    EXPECT_EQ(mFactoryInjector.GetOrCreateShared<IValueClassFactory>(3), obj_ptr) << "Composed object not cached";
+
+    // A slow creation shall not block the creation of other objects
+    auto slow_future  = std::async(std::launch::async, [&]() { return mFactoryInjector.GetOrCreateShared<IValueClassFactory>(ComposedValueClassFactory::kGatedValue); });
+    auto other_future = std::async(std::launch::async, [&]() { return mFactoryInjector.GetOrCreateShared<IValueClassFactory>(10); });
+    const bool cOtherReady = (other_future.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+    gate.set_value();
+
+    EXPECT_TRUE(cOtherReady) << "Creation blocked by a slow creation";
+    EXPECT_EQ(other_future.get()->GetValue(), 55) << "Wrong composed object";
+    EXPECT_EQ(slow_future.get()->GetValue(), ComposedValueClassFactory::kGatedValue) << "Wrong gated object";
+}
+
+// Test for GetOrCreateShared with C string arguments
+TEST_F(UTFactoryInjector, GetOrCreateSharedCString)
+{
+    // Register factory
+    mFactoryInjector.RegisterFactory<TextClassFactory>();
+
+    // C strings shall be compared by content, not by pointer
+    char text_1[] = "text";
+    char text_2[] = "text";
+    auto obj_ptr = mFactoryInjector.GetOrCreateShared<ITextClassFactory>(text_1);
+    EXPECT_EQ(obj_ptr->GetValue(), 4) << "Wrong object";
+    EXPECT_EQ(mFactoryInjector.GetOrCreateShared<ITextClassFactory>(static_cast<const char *>(text_2)), obj_ptr) << "C string compared by pointer";
+    EXPECT_NE(mFactoryInjector.GetOrCreateShared<ITextClassFactory>("other"), obj_ptr) << "Different C strings share the object";
+}
+
+// Test for CreateObjectsParallel
+TEST_F(UTFactoryInjector, CreateObjectsParallel)
+{
+    // Register a per-thread factory, so each thread updates its own counter
+    mFactoryInjector.RegisterFactoryPerThread<ValueClassFactory>();
+
+    // Objects shall be returned in index order
+    const std::size_t cCount = 1001;
+    auto objects = mFactoryInjector.CreateObjectsParallel<IValueClassFactory>(cCount,
+                                                                              [](std::size_t i) { return static_cast<int>(i * 2); },
+                                                                              ThreadExecutor(4));
+    ASSERT_EQ(objects.size(), cCount) << "Wrong number of created objects";
+    for (std::size_t i = 0; i < cCount; i++)
+    {
+        EXPECT_EQ(objects[i]->GetValue(), static_cast<int>(i * 2)) << "Wrong object at index " << i;
+    }
+
+    // Tuple arguments shall be unpacked
+    objects = mFactoryInjector.CreateObjectsParallel<IValueClassFactory>(10,
+                                                                         [](std::size_t i) { return std::make_tuple(static_cast<int>(i), 1); },
+                                                                         ThreadExecutor(3));
+    ASSERT_EQ(objects.size(), 10u) << "Wrong number of created objects";
+    for (std::size_t i = 0; i < objects.size(); i++)
+    {
+        EXPECT_EQ(objects[i]->GetValue(), static_cast<int>(i + 1)) << "Wrong object at index " << i;
+    }
+
+    // No objects
+    objects = mFactoryInjector.CreateObjectsParallel<IValueClassFactory>(0, [](std::size_t i) { return static_cast<int>(i); });
+    EXPECT_TRUE(objects.empty()) << "Objects created when none was requested";
+
+    // Getting a not-existent factory shall throw exception
+    EXPECT_THROW(mFactoryInjector.CreateObjectsParallel<IDummyClassFactory>(10, [](std::size_t) { return std::make_tuple(); }), FactoryNotRegisteredEx) << "Exception not thrown when getting a not existent factory";
+}
+
+// Test for ThreadExecutor
+TEST_F(UTFactoryInjector, ThreadExecutor)
+{
+    // Tasks running other tasks shall not deadlock, even if the pool is smaller than the number of tasks
+    std::atomic<int> task_count(0);
+    const ThreadExecutor cExecutor(4);
+    for (int i = 0; i < 10; i++)
+    {
+        cExecutor(8, [&](std::size_t) { cExecutor(8, [&](std::size_t) { task_count++; }); });
+    }
+    EXPECT_EQ(task_count.load(), 640) << "Wrong number of run tasks";
+
+    // The first exception shall be rethrown after all the tasks have finished
+    task_count = 0;
+    EXPECT_THROW(cExecutor(4, [&](std::size_t i) { task_count++; if (i == 2) { throw std::runtime_error("task"); } }), std::runtime_error) << "Task exception not rethrown";
+    EXPECT_EQ(task_count.load(), 4) << "Not all the tasks were run";
+}
+
+// Test for RegisterFactoryFunction
+TEST_F(UTFactoryInjector, RegisterFactoryFunction)
+{
+    // Factory function types
+    using tValueFunction = FactoryFunction<struct ValueTag, ValueClass, int>;
+    using tOtherFunction = FactoryFunction<struct OtherValueTag, ValueClass, int>;
+    using tDummyFunction = FactoryFunction<struct DummyTag, IDummyClass>;
+
+    // Register a lambda with captures
+    int offset = 100;
+    mFactoryInjector.RegisterFactoryFunction<tValueFunction>([offset](int value) { return std::make_unique<ValueClass>(value + offset); });
+    EXPECT_THROW(mFactoryInjector.RegisterFactoryFunction<tValueFunction>([](int value) { return std::make_unique<ValueClass>(value); }), FactoryAlreadyRegisteredEx) << "Exception not thrown when registering an already existent factory";
+
+    EXPECT_EQ(mFactoryInjector.CreateObject<tValueFunction>(1)->GetValue(), 101)  << "Wrong object from factory function";
+    EXPECT_EQ(mFactoryInjector.GetFactory<tValueFunction>().Create(2)->GetValue(), 102) << "Wrong object from factory function";
+
+    // Overwrite with a function pointer
+    struct Helper
+    {
+        static std::unique_ptr<ValueClass> Create(int value) { return std::make_unique<ValueClass>(-value); }
+    };
+    mFactoryInjector.OverwriteFactoryFunction<tValueFunction>(&Helper::Create);
+    EXPECT_EQ(mFactoryInjector.CreateObject<tValueFunction>(3)->GetValue(), -3) << "Wrong object after overwriting factory function";
+
+    // Factory functions with the same signature but different tags are different factories.
+    // This callable doesn't fit the internal buffer, so it's allocated on the heap.
+    const std::array<int, 16> values{ { 1, 2, 3 } };
+    static_assert(sizeof(values) > tOtherFunction::kBufferSize, "The callable shall not fit the internal buffer");
+    mFactoryInjector.RegisterFactoryFunction<tOtherFunction>([values](int value) { return std::make_unique<ValueClass>(values[2] * value); });
+    EXPECT_EQ(mFactoryInjector.CreateObject<tOtherFunction>(4)->GetValue(), 12) << "Wrong object from heap-allocated factory function";
+    EXPECT_EQ(mFactoryInjector.CreateObject<tValueFunction>(4)->GetValue(), -4) << "Factory function overwritten by one with a different tag";
+
+    // Factory functions can create derived objects
+    mFactoryInjector.RegisterFactoryFunction<tDummyFunction>([]() { return std::make_unique<DummyClass2>(); });
+    auto obj_ptr = mFactoryInjector.CreateObject<tDummyFunction>();
+    EXPECT_TRUE(ut_utils::IsOfType<DummyClass2>(*obj_ptr)) << "Wrong object type from factory function";
+
+    // Callables can implement the Create method of a factory interface
+    mFactoryInjector.RegisterFactoryFunction<IDummyClassFactory>([]() { return std::make_unique<DummyClass1>(); });
+    EXPECT_THROW(mFactoryInjector.RegisterFactoryFunction<IDummyClassFactory>([]() { return std::make_unique<DummyClass2>(); }), FactoryAlreadyRegisteredEx) << "Exception not thrown when registering an already existent factory";
+    EXPECT_TRUE(ut_utils::IsOfType<DummyClass1>(*mFactoryInjector.CreateObject<IDummyClassFactory>())) << "Wrong object type from interface function";
+
+    mFactoryInjector.RegisterFactoryFunction<ITextClassFactory>([offset](const char *pcText) { return std::make_unique<ValueClass>(static_cast<int>(std::strlen(pcText)) + offset); });
+    EXPECT_EQ(mFactoryInjector.CreateObject<ITextClassFactory>("abc")->GetValue(), 103) << "Wrong object from interface function";
+    EXPECT_EQ(mFactoryInjector.GetFactory<ITextClassFactory>().Create("ab")->GetValue(), 102) << "Wrong object from interface function";
+}
+
+// Test for RegisterAllStatic
+TEST_F(UTFactoryInjector, RegisterAllStatic)
+{
+    EXPECT_THROW(mFactoryInjector.GetFactory<IDummyClassFactory>(), FactoryNotRegisteredEx) << "Factory registered before RegisterAllStatic";
+
+    // Other descriptors may be linked in, so only the expected ones are checked
+    EXPECT_GE(mFactoryInjector.RegisterAllStatic(), 2u) << "Wrong number of static registrations";
+    EXPECT_TRUE(ut_utils::IsOfType<DummyClass1Factory>(mFactoryInjector.GetFactory<IDummyClassFactory>())) << "Wrong statically registered factory";
+    EXPECT_TRUE(ut_utils::IsOfType<ValueClassFactory>(mFactoryInjector.GetFactory<IValueClassFactory>())) << "Wrong statically registered factory";
+
+    // Factories are already registered
+    EXPECT_THROW(mFactoryInjector.RegisterAllStatic(), FactoryAlreadyRegisteredEx) << "Exception not thrown when registering static factories twice";
+}
+
+// Test for Fork
+TEST_F(UTFactoryInjector, Fork)
+{
+    mFactoryInjector.RegisterFactory<DummyClass1Factory>();
+    mFactoryInjector.RegisterFactory<ValueClassFactory>();
+
+    // The forked injector shares the factories
+    auto fork_ptr = mFactoryInjector.Fork();
+    EXPECT_EQ(&fork_ptr->GetFactory<IDummyClassFactory>(), &mFactoryInjector.GetFactory<IDummyClassFactory>()) << "Factory not shared with forked injector";
+    EXPECT_EQ(&fork_ptr->GetFactory<IValueClassFactory>(), &mFactoryInjector.GetFactory<IValueClassFactory>()) << "Factory not shared with forked injector";
+
+    // Overwriting a factory in the forked injector doesn't affect the original one, and vice versa
+    fork_ptr->OverwriteFactory<DummyClass2Factory>();
+    EXPECT_TRUE(ut_utils::IsOfType<DummyClass2Factory>(fork_ptr->GetFactory<IDummyClassFactory>()))        << "Factory not overwritten in forked injector";
+    EXPECT_TRUE(ut_utils::IsOfType<DummyClass1Factory>(mFactoryInjector.GetFactory<IDummyClassFactory>())) << "Factory overwritten in original injector";
+    EXPECT_EQ(&fork_ptr->GetFactory<IValueClassFactory>(), &mFactoryInjector.GetFactory<IValueClassFactory>()) << "Untouched factory not shared anymore";
+
+    mFactoryInjector.RegisterFactory<IOtherClassFactory>();
+    EXPECT_THROW(fork_ptr->GetFactory<IOtherClassFactory>(), FactoryNotRegisteredEx) << "Factory registered in forked injector";
+
+    // Shared factories outlive the original injector
+    auto fork_fork_ptr = fork_ptr->Fork();
+    fork_ptr.reset();
+    EXPECT_TRUE(ut_utils::IsOfType<DummyClass2>(*fork_fork_ptr->CreateObject<IDummyClassFactory>())) << "Wrong object type from forked injector";
+    EXPECT_EQ(fork_fork_ptr->CreateObject<IValueClassFactory>(5)->GetValue(), 5) << "Wrong object from forked injector";
+}
+
+// Test for factories with auto-wired dependencies
+TEST_F(UTFactoryInjector, AutoWireFactory)
+{
+    // Dependencies are resolved at registration
+    EXPECT_THROW(mFactoryInjector.RegisterFactory<CompositeClassFactory>(), FactoryNotRegisteredEx) << "Exception not thrown for missing dependencies";
+    EXPECT_THROW(mFactoryInjector.GetFactory<ICompositeClassFactory>(), FactoryNotRegisteredEx)   << "Factory registered with missing dependencies";
+
+    mFactoryInjector.RegisterFactory<ValueClassFactory>();
+    mFactoryInjector.RegisterFactory<DummyClass1Factory>();
+    mFactoryInjector.RegisterFactory<CompositeClassFactory>();
+
+    const auto& composite_factory = static_cast<const CompositeClassFactory&>(mFactoryInjector.GetFactory<ICompositeClassFactory>());
+    const auto& value_factory     = mFactoryInjector.GetFactory<IValueClassFactory>();
+    EXPECT_EQ(&composite_factory.GetValueFactory(), &value_factory) << "Wrong auto-wired dependency";
+    EXPECT_EQ(mFactoryInjector.CreateObject<ICompositeClassFactory>(1)->GetValue(), 2) << "Wrong object from auto-wired factory";
+    EXPECT_EQ(static_cast<const ValueClassFactory&>(value_factory).GetCreatedCount(), 1) << "Auto-wired dependency not used";
+
+    // Overwritten dependencies are kept alive for the factories referencing them
+    mFactoryInjector.OverwriteFactory<ValueClassFactory>();
+    EXPECT_NE(&composite_factory.GetValueFactory(), &mFactoryInjector.GetFactory<IValueClassFactory>()) << "Auto-wired dependency changed";
+    EXPECT_EQ(mFactoryInjector.CreateObject<ICompositeClassFactory>(2)->GetValue(), 3) << "Wrong object from auto-wired factory";
+    EXPECT_EQ(static_cast<const ValueClassFactory&>(composite_factory.GetValueFactory()).GetCreatedCount(), 2) << "Auto-wired dependency not kept alive";
+}
@@ -0,0 +1,159 @@
+/**
+ * Copyright (c) 2020 Emanuele Bellocchia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Includes
+ */
+
+// Google test
+#include "gtest/gtest.h"
+// Shared interfaces
+#include "ut_plugin_obj.hpp"
+// Class under test
+#include "factory_plugin.hpp"
+
+
+/*
+ * Using directives
+ */
+using namespace factory_injector;
+
+/*
+ * Classes
+ */
+
+// Object defined by the application
+class HostObj : public IPluginObj
+{
+    public:
+      HostObj(const int cValue) :
+        mValue(cValue)
+      {}
+
+      int GetValue(void) const override
+      {
+          return mValue;
+      }
+
+    private:
+      int mValue;
+};
+
+// Factory defined by the application
+class HostObjFactory : public IPluginObjFactory
+{
+    public:
+      tObjectPtr Create(const int cValue) const override
+      {
+          return std::make_unique<HostObj>(cValue);
+      }
+};
+
+/*
+ * Test fixture
+ */
+
+// Fixture for factory plugins
+class UTFactoryPlugin : public ::testing::Test
+{
+    /*
+     * Public methods
+     */
+    public:
+        // Constructor
+        UTFactoryPlugin(void)
+        {}
+
+        // Get if a test plugin is currently loaded
+        static bool IsPluginLoaded(const char *pcPluginPath)
+        {
+            void *p_handle = dlopen(pcPluginPath, RTLD_NOW | RTLD_NOLOAD);
+            if (p_handle != nullptr)
+            {
+                dlclose(p_handle);
+            }
+            return p_handle != nullptr;
+        }
+
+    /*
+     * Members
+     */
+    protected:
+        FactoryInjector mFactoryInjector;
+};
+
+/*
+ * Tests
+ */
+
+// Test for loading a plugin that overwrites a factory
+TEST_F(UTFactoryPlugin, LoadPlugin)
+{
+    // Register application factory
+    mFactoryInjector.RegisterFactory<HostObjFactory>();
+    EXPECT_EQ(mFactoryInjector.CreateObject<IPluginObjFactory>(2)->GetValue(), 2) << "Wrong object before loading plugin";
+
+    // Load plugin, its factory shall overwrite the application one
+    FactoryPluginLoader::Load(mFactoryInjector, UT_PLUGIN_PATH, PluginUnloadPolicy::UnloadWhenUnused);
+    EXPECT_EQ(mFactoryInjector.CreateObject<IPluginObjFactory>(2)->GetValue(), 200) << "Wrong object after loading plugin";
+}
+
+// Test for unloading a plugin when its factories and objects are not used anymore
+TEST_F(UTFactoryPlugin, UnloadWhenUnused)
+{
+    // Load plugin, it's used only by this test
+    FactoryPluginLoader::Load(mFactoryInjector, UT_UNLOAD_PLUGIN_PATH, PluginUnloadPolicy::UnloadWhenUnused);
+    EXPECT_TRUE(IsPluginLoaded(UT_UNLOAD_PLUGIN_PATH)) << "Plugin not loaded while its factory is registered";
+    auto obj_ptr = mFactoryInjector.CreateObject<IPluginObjFactory>(1);
+
+    // Overwrite the plugin factory, plugin shall stay loaded while its object is alive
+    mFactoryInjector.OverwriteFactory<HostObjFactory>();
+    FactoryPluginLoader::UnloadUnused();
+    EXPECT_TRUE(IsPluginLoaded(UT_UNLOAD_PLUGIN_PATH)) << "Plugin unloaded while its object is alive";
+    EXPECT_EQ(obj_ptr->GetValue(), 100) << "Wrong object from plugin factory";
+
+    // Release the object, plugin shall be unloaded only by UnloadUnused
+    obj_ptr.reset();
+    EXPECT_TRUE(IsPluginLoaded(UT_UNLOAD_PLUGIN_PATH)) << "Plugin unloaded before calling UnloadUnused";
+    EXPECT_EQ(FactoryPluginLoader::UnloadUnused(), 1U) << "Wrong number of unloaded plugins";
+    EXPECT_FALSE(IsPluginLoaded(UT_UNLOAD_PLUGIN_PATH)) << "Plugin still loaded after its factory and object have been released";
+}
+
+// Test for keeping a plugin loaded after its factories are not used anymore
+TEST_F(UTFactoryPlugin, KeepLoaded)
+{
+    // Load plugin and keep an object created by it
+    FactoryPluginLoader::Load(mFactoryInjector, UT_PLUGIN_PATH, PluginUnloadPolicy::KeepLoaded);
+    auto obj_ptr = mFactoryInjector.CreateObject<IPluginObjFactory>(3);
+
+    // Overwrite the plugin factory, plugin shall stay loaded so the object is still valid
+    mFactoryInjector.OverwriteFactory<HostObjFactory>();
+    FactoryPluginLoader::UnloadUnused();
+    EXPECT_TRUE(IsPluginLoaded(UT_PLUGIN_PATH)) << "Plugin unloaded while using KeepLoaded policy";
+    EXPECT_EQ(obj_ptr->GetValue(), 300) << "Wrong object from plugin factory";
+}
+
+// Test for loading a not-existent plugin
+TEST_F(UTFactoryPlugin, LoadNotExistentPlugin)
+{
+    EXPECT_THROW(FactoryPluginLoader::Load(mFactoryInjector, "not_existent_plugin.so"), PluginLoadEx) << "Exception not thrown when loading a not existent plugin";
+}
@@ -0,0 +1,158 @@
+/**
+ * Copyright (c) 2020 Emanuele Bellocchia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Includes
+ */
+
+// Google test
+#include "gtest/gtest.h"
+// Standard
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <string>
+#include <vector>
+// System
+#include <elf.h>
+// Utils
+#include "ut_utils.hpp"
+// Class under test
+#include "factory_injector.hpp"
+
+
+/*
+ * Using directives
+ */
+using namespace factory_injector;
+
+/*
+ * Classes
+ */
+
+// Probed class interface
+class IProbedClass
+{
+    public:
+      virtual ~IProbedClass(void) = default;
+};
+
+// Probed class
+class ProbedClass : public IProbedClass
+{};
+
+// Probed class factory interface
+class IProbedClassFactory : public FactoryTraits<IProbedClassFactory, IProbedClass>
+{
+    public:
+      virtual ~IProbedClassFactory(void) = default;
+      virtual tObjectPtr Create(void) const = 0;
+};
+
+// Probed class factory
+class ProbedClassFactory : public IProbedClassFactory
+{
+    public:
+      tObjectPtr Create(void) const override
+      {
+          return std::make_unique<ProbedClass>();
+      }
+};
+
+/*
+ * Functions
+ */
+
+// Get the names of the factory_injector probes in the USDT notes of the running executable
+static std::set<std::string> GetProbeNames(void)
+{
+    std::ifstream file("/proc/self/exe", std::ios::binary);
+    std::vector<char> elf((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    std::set<std::string> names;
+    if (elf.size() < sizeof(Elf64_Ehdr))
+    {
+        return names;
+    }
+
+    const auto* p_ehdr     = reinterpret_cast<const Elf64_Ehdr*>(elf.data());
+    const auto* p_shdrs    = reinterpret_cast<const Elf64_Shdr*>(elf.data() + p_ehdr->e_shoff);
+    const char* p_shstrtab = elf.data() + p_shdrs[p_ehdr->e_shstrndx].sh_offset;
+
+    for (std::size_t i = 0; i < p_ehdr->e_shnum; i++)
+    {
+        if (p_shdrs[i].sh_type != SHT_NOTE || std::strcmp(p_shstrtab + p_shdrs[i].sh_name, ".note.stapsdt") != 0)
+        {
+            continue;
+        }
+
+        // Each note: header, "stapsdt" name, descriptor (pc, base, semaphore, provider, name, arguments)
+        std::size_t offset = p_shdrs[i].sh_offset;
+        const std::size_t end = offset + p_shdrs[i].sh_size;
+        while (offset + sizeof(Elf64_Nhdr) <= end)
+        {
+            const auto* p_nhdr = reinterpret_cast<const Elf64_Nhdr*>(elf.data() + offset);
+            const char* p_desc = elf.data() + offset + sizeof(Elf64_Nhdr) + ((p_nhdr->n_namesz + 3) & ~3u);
+
+            const std::string provider(p_desc + 3 * sizeof(std::uint64_t));
+            if (provider == "factory_injector")
+            {
+                names.insert(std::string(p_desc + 3 * sizeof(std::uint64_t) + provider.size() + 1));
+            }
+
+            offset += sizeof(Elf64_Nhdr) + ((p_nhdr->n_namesz + 3) & ~3u) + ((p_nhdr->n_descsz + 3) & ~3u);
+        }
+    }
+
+    return names;
+}
+
+/*
+ * Tests
+ */
+
+// Test for USDT probes
+TEST(UTFactoryProbes, ProbesInElfNotes)
+{
+    if (!FACTORY_INJECTOR_USDT_ENABLED)
+    {
+        GTEST_SKIP() << "USDT probes not enabled for this platform";
+    }
+
+    // Fire all probes, nothing shall happen without a tracer
+    FactoryInjector factory_injector;
+    factory_injector.RegisterFactory<ProbedClassFactory>();
+    factory_injector.OverwriteFactory<ProbedClassFactory>();
+    EXPECT_TRUE(ut_utils::IsOfType<ProbedClass>(*factory_injector.CreateObject<IProbedClassFactory>())) << "Wrong object type with probes enabled";
+
+    FactoryInjector empty_injector;
+    EXPECT_THROW(empty_injector.GetFactory<IProbedClassFactory>(), FactoryNotRegisteredEx) << "Exception not thrown with probes enabled";
+
+    // Check notes
+    const auto names = GetProbeNames();
+    for (const auto* p_name : { "lookup", "miss", "create_start", "create_end", "register", "overwrite" })
+    {
+        EXPECT_EQ(names.count(p_name), 1u) << "Probe not found in ELF notes: " << p_name;
+    }
+}
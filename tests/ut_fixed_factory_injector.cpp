@@ -0,0 +1,274 @@
+/**
+ * Copyright (c) 2020 Emanuele Bellocchia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Includes
+ */
+
+// Google test
+#include "gtest/gtest.h"
+// Standard
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+// Utils
+#include "ut_utils.hpp"
+// Class under test
+#include "fixed_factory_injector.hpp"
+
+
+/*
+ * Using directives
+ */
+using namespace factory_injector;
+
+/*
+ * Global variables
+ */
+
+// If true, the global operator new fails (only in the thread setting it, other threads may allocate meanwhile)
+static thread_local bool gFailNew = false;
+// Number of failed allocations
+static std::atomic<int> gFailedNewCount(0);
+
+/*
+ * Global operators
+ */
+
+// Global operator new, it fails if requested
+void* operator new(std::size_t size)
+{
+    if (gFailNew)
+    {
+        gFailedNewCount++;
+        throw std::bad_alloc();
+    }
+
+    void* p = std::malloc((size != 0) ? size : 1);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+// Global operator delete
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+// Global operator delete (sized)
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+/*
+ * Classes
+ */
+
+// Fixed class interface
+class IFixedClass
+{
+    public:
+      virtual ~IFixedClass(void) = default;
+};
+
+// Fixed class
+class FixedClass : public IFixedClass
+{};
+
+// Fixed class factory interface
+class IFixedClassFactory : public FactoryTraits<IFixedClassFactory, IFixedClass>
+{
+    public:
+      virtual ~IFixedClassFactory(void)     = default;
+      virtual tObjectPtr Create(void) const = 0;
+};
+
+// Fixed class factory
+class FixedClassFactory : public IFixedClassFactory
+{
+    public:
+      tObjectPtr Create(void) const override
+      {
+          return std::make_unique<FixedClass>();
+      }
+};
+
+// Other fixed class factory, it keeps a value (nothrow constructible, so its storage can be reused)
+class OtherFixedClassFactory : public FactoryTraits<OtherFixedClassFactory, IFixedClass>
+{
+    public:
+      OtherFixedClassFactory(const int cValue) noexcept :
+        mValue(cValue)
+      {}
+
+      int GetValue(void) const
+      {
+          return mValue;
+      }
+
+    private:
+      int mValue;
+};
+
+// Throwing fixed class factory, it keeps a value (its constructor can throw, so its storage cannot be reused)
+class ThrowingFixedClassFactory : public FactoryTraits<ThrowingFixedClassFactory, IFixedClass>
+{
+    public:
+      ThrowingFixedClassFactory(const int cValue) :
+        mValue(cValue)
+      {
+          if (cValue < 0)
+          {
+              throw std::invalid_argument("Negative value");
+          }
+      }
+
+      int GetValue(void) const
+      {
+          return mValue;
+      }
+
+    private:
+      int mValue;
+};
+
+// Third fixed class factory
+class ThirdFixedClassFactory : public FactoryTraits<ThirdFixedClassFactory, IFixedClass>
+{
+    private:
+      char mPayload[56];
+};
+
+/*
+ * Tests
+ */
+
+// Test for registering and getting factories
+TEST(UTFixedFactoryInjector, RegisterAndGetFactory)
+{
+    FixedFactoryInjector<2, 256> factory_injector;
+
+    factory_injector.RegisterFactory<FixedClassFactory>();
+    factory_injector.RegisterFactory<OtherFixedClassFactory>(10);
+    EXPECT_THROW(factory_injector.RegisterFactory<FixedClassFactory>(), FactoryAlreadyRegisteredEx) << "Exception not thrown when registering an already existent factory";
+    EXPECT_THROW(factory_injector.GetFactory<ThirdFixedClassFactory>(), FactoryNotRegisteredEx)     << "Exception not thrown when getting a not existent factory";
+
+    EXPECT_TRUE(ut_utils::IsOfType<FixedClassFactory>(factory_injector.GetFactory<IFixedClassFactory>())) << "Wrong factory type";
+    EXPECT_EQ(factory_injector.GetFactory<OtherFixedClassFactory>().GetValue(), 10) << "Wrong factory";
+    EXPECT_TRUE(ut_utils::IsOfType<FixedClass>(*factory_injector.CreateObject<IFixedClassFactory>())) << "Wrong object type";
+
+    factory_injector.OverwriteFactory<OtherFixedClassFactory>(20);
+    EXPECT_EQ(factory_injector.GetFactory<OtherFixedClassFactory>().GetValue(), 20) << "Factory not overwritten";
+    EXPECT_EQ(factory_injector.GetFactoryCount(), 2u) << "Wrong factory count";
+}
+
+// Test for registering factories when the capacity or the storage is exceeded
+TEST(UTFixedFactoryInjector, CapacityExceeded)
+{
+    FixedFactoryInjector<2, 60> factory_injector;
+
+    factory_injector.RegisterFactory<FixedClassFactory>();
+    EXPECT_THROW(factory_injector.RegisterFactory<ThirdFixedClassFactory>(), FactoryCapacityExceededEx) << "Exception not thrown when the storage is exceeded";
+    factory_injector.RegisterFactory<OtherFixedClassFactory>(1);
+    EXPECT_THROW(factory_injector.RegisterFactory<ThirdFixedClassFactory>(), FactoryCapacityExceededEx) << "Exception not thrown when the capacity is exceeded";
+    EXPECT_EQ(factory_injector.GetFactoryCount(), 2u) << "Wrong factory count";
+}
+
+// Test for overwriting factories, the storage shall be reused if possible
+TEST(UTFixedFactoryInjector, OverwriteReuseStorage)
+{
+    FixedFactoryInjector<2, 256> factory_injector;
+
+    factory_injector.RegisterFactory<OtherFixedClassFactory>(1);
+    const std::size_t cUsedStorage = factory_injector.GetUsedStorage();
+    for (int i = 0; i < 100; i++)
+    {
+        factory_injector.OverwriteFactory<OtherFixedClassFactory>(i);
+    }
+    EXPECT_EQ(factory_injector.GetUsedStorage(), cUsedStorage) << "Storage not reused";
+    EXPECT_EQ(factory_injector.GetFactory<OtherFixedClassFactory>().GetValue(), 99) << "Factory not overwritten";
+}
+
+// Test for overwriting factories whose constructor can throw, the storage shall be reclaimed for the last allocated one
+TEST(UTFixedFactoryInjector, OverwriteThrowingFactory)
+{
+    FixedFactoryInjector<2, 256> factory_injector;
+
+    factory_injector.RegisterFactory<FixedClassFactory>();
+    factory_injector.RegisterFactory<ThrowingFixedClassFactory>(1);
+    const std::size_t cUsedStorage = factory_injector.GetUsedStorage();
+    for (int i = 0; i < 100; i++)
+    {
+        factory_injector.OverwriteFactory<ThrowingFixedClassFactory>(i);
+        EXPECT_LE(factory_injector.GetUsedStorage(), cUsedStorage + sizeof(ThrowingFixedClassFactory)) << "Storage not reclaimed";
+    }
+    EXPECT_EQ(factory_injector.GetFactory<ThrowingFixedClassFactory>().GetValue(), 99) << "Factory not overwritten";
+
+    // If the constructor throws, the previous factory shall be kept
+    const std::size_t cLastUsedStorage = factory_injector.GetUsedStorage();
+    EXPECT_THROW(factory_injector.OverwriteFactory<ThrowingFixedClassFactory>(-1), std::invalid_argument) << "Constructor exception not propagated";
+    EXPECT_EQ(factory_injector.GetFactory<ThrowingFixedClassFactory>().GetValue(), 99) << "Previous factory not kept";
+    EXPECT_EQ(factory_injector.GetUsedStorage(), cLastUsedStorage) << "Storage changed by a failed overwrite";
+    EXPECT_TRUE(ut_utils::IsOfType<FixedClassFactory>(factory_injector.GetFactory<IFixedClassFactory>())) << "Other factory corrupted";
+}
+
+// Test that no memory is allocated, also when the capacity is exceeded
+TEST(UTFixedFactoryInjector, NoAllocation)
+{
+    FixedFactoryInjector<2, 60> factory_injector;
+
+    FixedRegisterResult results[6];
+    bool factory_found = false;
+
+    gFailNew = true;
+    gFailedNewCount = 0;
+    try
+    {
+        results[0] = factory_injector.TryRegisterFactory<FixedClassFactory>();
+        results[1] = factory_injector.TryOverwriteFactory<FixedClassFactory>();
+        results[2] = factory_injector.TryRegisterFactory<FixedClassFactory>();
+        results[3] = factory_injector.TryRegisterFactory<ThirdFixedClassFactory>();
+        results[4] = factory_injector.TryRegisterFactory<OtherFixedClassFactory>(1);
+        results[5] = factory_injector.TryRegisterFactory<ThirdFixedClassFactory>();
+
+        factory_found = (factory_injector.GetFactory<OtherFixedClassFactory>().GetValue() == 1);
+    }
+    catch (const std::bad_alloc&)
+    {
+    }
+    gFailNew = false;
+
+    EXPECT_EQ(gFailedNewCount.load(), 0) << "Memory allocated";
+    EXPECT_EQ(results[0], FixedRegisterResult::Registered)        << "Factory not registered";
+    EXPECT_EQ(results[1], FixedRegisterResult::Overwritten)       << "Factory not overwritten";
+    EXPECT_EQ(results[2], FixedRegisterResult::AlreadyRegistered) << "Factory registered twice";
+    EXPECT_EQ(results[3], FixedRegisterResult::StorageExceeded)   << "Storage not exceeded";
+    EXPECT_EQ(results[4], FixedRegisterResult::Registered)        << "Factory not registered";
+    EXPECT_EQ(results[5], FixedRegisterResult::CapacityExceeded)  << "Capacity not exceeded";
+    EXPECT_TRUE(factory_found)                                    << "Factory not found";
+    EXPECT_EQ(factory_injector.GetFactoryCount(), 2u) << "Wrong factory count";
+}
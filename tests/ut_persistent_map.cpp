@@ -0,0 +1,124 @@
+/**
+ * Copyright (c) 2020 Emanuele Bellocchia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Includes
+ */
+
+// Google test
+#include "gtest/gtest.h"
+// Standard
+#include <cstddef>
+#include <memory>
+#include <set>
+// Class under test
+#include "persistent_map.hpp"
+
+
+/*
+ * Using directives
+ */
+using namespace factory_injector::persistent_details;
+
+/*
+ * Classes
+ */
+
+// Hash with few distinct values, for testing collisions
+struct CollidingHash
+{
+    std::size_t operator()(const int cKey) const
+    {
+        return static_cast<std::size_t>(cKey % 7);
+    }
+};
+
+/*
+ * Tests
+ */
+
+// Test for Set and Find
+TEST(UTPersistentMap, SetAndFind)
+{
+    PersistentMap<int, int> map;
+    EXPECT_EQ(map.Find(1), nullptr) << "Value found in empty map";
+
+    for (int i = 0; i < 1000; i++)
+    {
+        EXPECT_TRUE(map.Set(i, std::make_shared<int>(i * 2))) << "Value not inserted";
+    }
+    EXPECT_FALSE(map.Set(10, std::make_shared<int>(-1))) << "Value not replaced";
+    EXPECT_EQ(map.Size(), 1000u) << "Wrong size";
+
+    for (int i = 0; i < 1000; i++)
+    {
+        ASSERT_NE(map.Find(i), nullptr) << "Value not found";
+        EXPECT_EQ(*map.Find(i), (i == 10) ? -1 : i * 2) << "Wrong value";
+    }
+    EXPECT_EQ(map.Find(1000), nullptr) << "Not existent value found";
+
+    std::set<int> keys;
+    map.ForEach([&keys](const int cKey, const int) { keys.insert(cKey); });
+    EXPECT_EQ(keys.size(), 1000u) << "Wrong number of iterated items";
+}
+
+// Test for hash collisions
+TEST(UTPersistentMap, Collisions)
+{
+    PersistentMap<int, int, CollidingHash> map;
+
+    for (int i = 0; i < 100; i++)
+    {
+        map.Set(i, std::make_shared<int>(i));
+    }
+    map.Set(50, std::make_shared<int>(-50));
+
+    EXPECT_EQ(map.Size(), 100u) << "Wrong size";
+    for (int i = 0; i < 100; i++)
+    {
+        ASSERT_NE(map.Find(i), nullptr) << "Value not found";
+        EXPECT_EQ(*map.Find(i), (i == 50) ? -50 : i) << "Wrong value";
+    }
+}
+
+// Test for copies sharing nodes
+TEST(UTPersistentMap, Copy)
+{
+    PersistentMap<int, int> map;
+    for (int i = 0; i < 100; i++)
+    {
+        map.Set(i, std::make_shared<int>(i));
+    }
+
+    auto map_copy = map;
+    map_copy.Set(5, std::make_shared<int>(-5));
+    map_copy.Set(100, std::make_shared<int>(100));
+
+    // Untouched values are shared
+    EXPECT_EQ(map_copy.Find(6), map.Find(6)) << "Value not shared";
+    // Changes are visible only in the copy
+    EXPECT_EQ(*map.Find(5), 5)       << "Original map modified";
+    EXPECT_EQ(*map_copy.Find(5), -5) << "Copied map not modified";
+    EXPECT_EQ(map.Find(100), nullptr) << "Original map modified";
+    EXPECT_EQ(map.Size(), 100u)       << "Wrong original size";
+    EXPECT_EQ(map_copy.Size(), 101u)  << "Wrong copied size";
+}
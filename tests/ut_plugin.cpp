@@ -0,0 +1,70 @@
+/**
+ * Copyright (c) 2020 Emanuele Bellocchia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Includes
+ */
+
+// Shared interfaces
+#include "ut_plugin_obj.hpp"
+// Plugin support
+#include "factory_plugin.hpp"
+
+/*
+ * Classes
+ */
+
+// Object defined by the plugin
+class PluginObj : public IPluginObj
+{
+    public:
+      PluginObj(const int cValue) :
+        mValue(cValue)
+      {}
+
+      int GetValue(void) const override
+      {
+          return mValue * 100;
+      }
+
+    private:
+      int mValue;
+};
+
+// Factory defined by the plugin
+class PluginObjFactory : public IPluginObjFactory
+{
+    public:
+      tObjectPtr Create(const int cValue) const override
+      {
+          return std::make_unique<PluginObj>(cValue);
+      }
+};
+
+/*
+ * Plugin entry point
+ */
+
+FACTORY_INJECTOR_PLUGIN(rRegistrar)
+{
+    rRegistrar.OverwriteFactory<PluginObjFactory>();
+}
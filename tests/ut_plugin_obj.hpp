@@ -0,0 +1,54 @@
+/**
+ * Copyright (c) 2020 Emanuele Bellocchia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _UT_PLUGIN_OBJ_HPP_
+#define _UT_PLUGIN_OBJ_HPP_
+
+/*
+ * Includes
+ */
+
+// Project
+#include "factory_injector.hpp"
+#include "factory_plugin.hpp"
+
+/*
+ * Classes
+ */
+
+// Object interface shared by the unit tests and the test plugin
+class IPluginObj
+{
+    public:
+      virtual ~IPluginObj(void)           = default;
+      virtual int GetValue(void) const = 0;
+};
+
+// Object factory interface shared by the unit tests and the test plugin, its objects keep the plugin loaded
+class IPluginObjFactory : public factory_injector::FactoryTraits<IPluginObjFactory, IPluginObj, factory_injector::PluginDelete>
+{
+    public:
+      virtual ~IPluginObjFactory(void)                  = default;
+      virtual tObjectPtr Create(const int cValue) const = 0;
+};
+
+#endif  // _UT_PLUGIN_OBJ_HPP_
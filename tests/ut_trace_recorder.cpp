@@ -0,0 +1,230 @@
+/**
+ * Copyright (c) 2020 Emanuele Bellocchia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Includes
+ */
+
+// Google test
+#include "gtest/gtest.h"
+// Standard
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <typeinfo>
+#include <vector>
+// System
+#include <fcntl.h>
+#include <unistd.h>
+// Class under test
+#include "factory_injector.hpp"
+#include "trace_recorder.hpp"
+
+
+/*
+ * Using directives
+ */
+using namespace factory_injector;
+
+/*
+ * Classes
+ */
+
+// Traced class
+class TracedClass
+{
+    public:
+      TracedClass(const int cValue) :
+        mValue(cValue)
+      {}
+
+      int GetValue(void) const
+      {
+          return mValue;
+      }
+
+    private:
+      int mValue;
+};
+
+// Traced class factory interface
+class ITracedClassFactory : public FactoryTraits<ITracedClassFactory, TracedClass>
+{
+    public:
+      virtual ~ITracedClassFactory(void)                = default;
+      virtual tObjectPtr Create(const int cValue) const = 0;
+};
+
+// Traced class factory
+class TracedClassFactory : public ITracedClassFactory
+{
+    public:
+      tObjectPtr Create(const int cValue) const override
+      {
+          return std::make_unique<TracedClass>(cValue);
+      }
+};
+
+// Temporary trace file, removed when destroyed
+class TempTraceFile
+{
+    public:
+      TempTraceFile(void) :
+        mPath("/tmp/ut_trace_" + std::to_string(::getpid()) + ".bin")
+      {}
+
+      ~TempTraceFile(void)
+      {
+          ::unlink(mPath.c_str());
+      }
+
+      const std::string& GetPath(void) const
+      {
+          return mPath;
+      }
+
+    private:
+      std::string mPath;
+};
+
+/*
+ * Tests
+ */
+
+// Test for recording injector events
+TEST(UTTraceRecorder, RecordInjector)
+{
+    TempTraceFile file;
+    {
+        TraceRecorder recorder(file.GetPath(), 16);
+        FactoryInjector injector;
+
+        injector.RegisterFactory<TracedClassFactory>();
+        injector.CreateObject<TracedClassFactory>(1);
+        injector.SetTraceRecorder(&recorder);
+        injector.OverwriteFactory<TracedClassFactory>();
+        injector.GetFactory<TracedClassFactory>();
+        EXPECT_EQ(injector.CreateObject<TracedClassFactory>(2)->GetValue(), 2) << "Wrong object";
+        injector.SetTraceRecorder(nullptr);
+        injector.CreateObject<TracedClassFactory>(3);
+    }
+
+    const auto events = TraceReader::Read(file.GetPath());
+    ASSERT_EQ(events.size(), 3u) << "Wrong number of events";
+
+    EXPECT_EQ(events[0].mType, TraceEventType::OverwriteFactory) << "Wrong event type";
+    EXPECT_EQ(events[1].mType, TraceEventType::GetFactory) << "Wrong event type";
+    EXPECT_EQ(events[2].mType, TraceEventType::CreateObject) << "Wrong event type";
+    EXPECT_EQ(events[2].mArgBytes, sizeof(int)) << "Wrong arguments size";
+    for (const auto& event : events)
+    {
+        EXPECT_EQ(event.mTypeId, trace_details::HashTypeName(typeid(ITracedClassFactory).name())) << "Wrong type id";
+        EXPECT_EQ(event.mThreadId, events[0].mThreadId) << "Wrong thread id";
+    }
+    EXPECT_LE(events[0].mTimestampNs, events[1].mTimestampNs) << "Events not ordered";
+    EXPECT_LE(events[1].mTimestampNs, events[2].mTimestampNs) << "Events not ordered";
+
+    // The interface name shall be in the name table
+    const auto names = TraceReader::ReadNames(file.GetPath());
+    ASSERT_EQ(names.size(), 1u) << "Wrong number of names";
+    EXPECT_EQ(names.begin()->first, events[0].mTypeId) << "Wrong type id in name table";
+    EXPECT_EQ(names.begin()->second, typeid(ITracedClassFactory).name()) << "Wrong name in name table";
+}
+
+// Test for incomplete events, e.g. interrupted by a crash
+TEST(UTTraceRecorder, IncompleteEvents)
+{
+    TempTraceFile file;
+    {
+        TraceRecorder recorder(file.GetPath(), 4);
+        for (std::uint64_t i = 0; i < 4; i++)
+        {
+            recorder.Record(TraceEventType::GetFactory, i + 1, recorder.Now());
+        }
+    }
+
+    // Mark an event as being written and move another one to a wrong position
+    const int fd = ::open(file.GetPath().c_str(), O_WRONLY);
+    ASSERT_GE(fd, 0) << "Trace file not opened";
+    const std::uint64_t cSequences[2] = { trace_details::kBusySequence, 4 };
+    for (std::size_t i = 0; i < 2; i++)
+    {
+        const off_t offset = static_cast<off_t>(sizeof(trace_details::FileHeader) +
+                                                trace_details::kNameCount * sizeof(trace_details::NameEntry) +
+                                                (i + 1) * sizeof(TraceEvent));
+        EXPECT_EQ(::pwrite(fd, &cSequences[i], sizeof(cSequences[i]), offset), static_cast<ssize_t>(sizeof(cSequences[i]))) << "Trace file not written";
+    }
+    ::close(fd);
+
+    const auto events = TraceReader::Read(file.GetPath());
+    ASSERT_EQ(events.size(), 2u) << "Incomplete events not skipped";
+    EXPECT_EQ(events[0].mTypeId, 1u) << "Wrong event";
+    EXPECT_EQ(events[1].mTypeId, 4u) << "Wrong event";
+}
+
+// Test for ring wrapping
+TEST(UTTraceRecorder, RingWrap)
+{
+    TempTraceFile file;
+    {
+        TraceRecorder recorder(file.GetPath(), 4);
+        for (std::uint64_t i = 0; i < 10; i++)
+        {
+            recorder.Record(TraceEventType::GetFactory, i, recorder.Now());
+        }
+    }
+
+    const auto events = TraceReader::Read(file.GetPath());
+    ASSERT_EQ(events.size(), 4u) << "Wrong number of events";
+    for (std::size_t i = 0; i < events.size(); i++)
+    {
+        EXPECT_EQ(events[i].mSequence, i + 7) << "Oldest events not overwritten";
+        EXPECT_EQ(events[i].mTypeId, i + 6) << "Wrong event";
+    }
+}
+
+// Test for invalid files
+TEST(UTTraceRecorder, InvalidFile)
+{
+    EXPECT_THROW(TraceRecorder("/not_existent_dir/trace.bin", 4), TraceFileEx) << "File created in not existent directory";
+    EXPECT_THROW(TraceReader::Read("/not_existent_dir/trace.bin"), TraceFileEx) << "Not existent file read";
+    EXPECT_THROW(TraceReader::Read("/proc/self/cmdline"), TraceFileEx) << "Invalid file read";
+
+    // Header sizes that overflow when converted to bytes
+    TempTraceFile file;
+    {
+        TraceRecorder recorder(file.GetPath(), 4);
+    }
+    const int fd = ::open(file.GetPath().c_str(), O_WRONLY);
+    ASSERT_GE(fd, 0) << "Trace file not opened";
+    const std::uint64_t cCapacities[2] = { (UINT64_MAX / sizeof(TraceEvent)) + 2, 4 };
+    EXPECT_EQ(::pwrite(fd, &cCapacities[0], sizeof(cCapacities[0]), offsetof(trace_details::FileHeader, mCapacity)), static_cast<ssize_t>(sizeof(cCapacities[0]))) << "Trace file not written";
+    EXPECT_THROW(TraceReader::Read(file.GetPath()), TraceFileEx) << "File with overflowing capacity read";
+    EXPECT_EQ(::pwrite(fd, &cCapacities[1], sizeof(cCapacities[1]), offsetof(trace_details::FileHeader, mCapacity)), static_cast<ssize_t>(sizeof(cCapacities[1]))) << "Trace file not written";
+    EXPECT_NO_THROW(TraceReader::Read(file.GetPath())) << "Valid file not read";
+
+    const std::uint32_t cNameCount = UINT32_MAX;
+    EXPECT_EQ(::pwrite(fd, &cNameCount, sizeof(cNameCount), offsetof(trace_details::FileHeader, mNameCount)), static_cast<ssize_t>(sizeof(cNameCount))) << "Trace file not written";
+    EXPECT_THROW(TraceReader::ReadNames(file.GetPath()), TraceFileEx) << "File with too many names read";
+    ::close(fd);
+}